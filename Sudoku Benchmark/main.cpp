@@ -0,0 +1,249 @@
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "SudokuSolver.h"
+#include "DancingLinksSolver.h"
+#include "ParallelSolver.h"
+#include "BatchSolver.h"
+#include "SudokuGenerator.h"
+
+// usage : "Sudoku Benchmark" [puzzle file] [max threads]
+// puzzle file : one 9x9 puzzle per line, 81 characters with '.' or '0' for empty cells
+
+typedef std::vector<std::uint8_t> Puzzle;
+
+// hard puzzles used when no file is given
+const char* DefaultPuzzles[] = {
+	"000000010400000000020000000000050407008000300001090000300400200050100000000806000",
+	"000000000000003085001020000000507000004000100090000000500000073002010000000040009",
+	"800000000003600000070090200050007000000045700000100030001000068008500010090000400",
+	"100007090030020008009600500005300900010080002600004000300000010040000007007000300",
+	"000000012000035000000600070700000300000400800100000000000120000080000040050000600",
+	"000000012003600000000007000410020000000500300700000600280000040000300500000000000"
+};
+
+std::vector<Puzzle> LoadPuzzles(const char* path);
+double Milliseconds(std::chrono::steady_clock::time_point start);
+
+void PrintStats(const SolveStats& stats);
+
+void BenchmarkEngines(const std::vector<Puzzle>& puzzles);
+void BenchmarkBatch(const std::vector<Puzzle>& puzzles);
+void BenchmarkParallel(const std::vector<Puzzle>& puzzles, int maxThreads);
+void BenchmarkGenerator(int maxThreads);
+
+int main(int argc, char* argv[])
+{
+	// a thread count that does not parse or is not positive prints the usage
+	int maxThreads = std::max(1, (int)std::thread::hardware_concurrency());
+	if (argc > 2)
+	{
+		try
+		{
+			maxThreads = std::stoi(argv[2]);
+		}
+		catch (const std::exception&)
+		{
+			maxThreads = 0;
+		}
+
+		if (maxThreads <= 0)
+		{
+			std::cout << "usage : " << argv[0] << " [puzzle file] [max threads]" << std::endl;
+			return -1;
+		}
+	}
+
+	std::vector<Puzzle> puzzles = LoadPuzzles(argc > 1 ? argv[1] : nullptr);
+
+	if (puzzles.empty())
+	{
+		std::cout << "No puzzles to run" << std::endl;
+		return -1;
+	}
+
+	std::cout << std::fixed << std::setprecision(2);
+	std::cout << puzzles.size() << " puzzles" << std::endl << std::endl;
+
+	BenchmarkEngines(puzzles);
+	BenchmarkBatch(puzzles);
+	BenchmarkParallel(puzzles, maxThreads);
+	BenchmarkGenerator(maxThreads);
+
+	return 0;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//														Utility functions
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+std::vector<Puzzle> LoadPuzzles(const char* path)
+{
+	std::vector<Puzzle> puzzles;
+	std::vector<std::string> lines;
+
+	if (path)
+	{
+		std::ifstream file(path);
+		if (!file)
+			std::cout << "ERROR::BENCHMARK: Failed to open " << path << std::endl;
+
+		std::string line;
+		while (std::getline(file, line))
+			lines.push_back(line);
+	}
+	else
+	{
+		for (const char* line : DefaultPuzzles)
+			lines.push_back(line);
+	}
+
+	for (const std::string& line : lines)
+	{
+		if (line.size() < SudokuSolver::Cells)
+			continue;
+
+		Puzzle puzzle(SudokuSolver::Cells);
+		for (int i = 0; i < SudokuSolver::Cells; i++)
+			puzzle[i] = (line[i] >= '1' && line[i] <= '9' ? line[i] - '0' : 0);
+		puzzles.push_back(puzzle);
+	}
+
+	return puzzles;
+}
+
+double Milliseconds(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void PrintStats(const SolveStats& stats)
+{
+	std::cout << "  nodes " << stats.Nodes << ", backtracks " << stats.Backtracks << ", max depth " << stats.MaxDepth << std::endl;
+	std::cout << "  propagations " << stats.Propagations << ", naked singles " << stats.NakedSingles << ", hidden singles " << stats.HiddenSingles << std::endl;
+	std::cout << "  validation " << 1000.0 * stats.ValidationTime << " ms, propagation " << 1000.0 * stats.PropagationTime
+		<< " ms, search " << 1000.0 * stats.SearchTime << " ms" << std::endl;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//														Benchmarks
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void BenchmarkEngines(const std::vector<Puzzle>& puzzles)
+{
+	SudokuSolver backtracking;
+	DancingLinksSolver dancingLinks;
+
+	SudokuEngine* engines[] = { &backtracking, &dancingLinks };
+	const char* names[] = { "bkt", "dancing links" };
+
+	std::cout << "engine            total ms    us / puzzle    solved" << std::endl;
+
+	for (int e = 0; e < 2; e++)
+	{
+		int solved = 0;
+		auto start = std::chrono::steady_clock::now();
+
+		for (const Puzzle& puzzle : puzzles)
+		{
+			for (int i = 0; i < SudokuSolver::Cells; i++)
+				engines[e]->SetTableValue(i / 9 + 1, i % 9 + 1, puzzle[i]);
+
+			if (engines[e]->Solve())
+				solved++;
+		}
+
+		double total = Milliseconds(start);
+		std::cout << std::left << std::setw(18) << names[e] << std::right
+			<< std::setw(8) << total << std::setw(15) << 1000.0 * total / puzzles.size() << std::setw(10) << solved << std::endl;
+	}
+
+	std::cout << std::endl;
+}
+
+void BenchmarkBatch(const std::vector<Puzzle>& puzzles)
+{
+	std::vector<std::uint8_t> buffer;
+	for (const Puzzle& puzzle : puzzles)
+		buffer.insert(buffer.end(), puzzle.begin(), puzzle.end());
+
+	std::vector<SolveStatus> status(puzzles.size());
+	std::vector<SolveStats> stats;
+	SOLVE_STATS(stats.resize(puzzles.size());)
+
+	auto start = std::chrono::steady_clock::now();
+	SolveBatch<3, 3>(buffer.data(), buffer.data(), status.data(), puzzles.size(), 0, SolveLimits(), stats.empty() ? nullptr : stats.data());
+	double total = Milliseconds(start);
+
+	std::cout << "batch             " << std::setw(8) << total << std::setw(15) << 1000.0 * total / puzzles.size() << std::endl;
+
+	if (stats.empty())
+	{
+		std::cout << "  (build with SUDOKU_STATS for search counters)" << std::endl << std::endl;
+		return;
+	}
+
+	// totals, then the puzzle that kept the search busy the longest
+	SolveStats sum;
+	std::size_t slowest = 0;
+	for (std::size_t i = 0; i < stats.size(); i++)
+	{
+		sum += stats[i];
+		if (stats[i].SearchTime > stats[slowest].SearchTime)
+			slowest = i;
+	}
+
+	PrintStats(sum);
+	std::cout << "slowest puzzle: #" << slowest + 1 << std::endl;
+	PrintStats(stats[slowest]);
+	std::cout << std::endl;
+}
+
+void BenchmarkParallel(const std::vector<Puzzle>& puzzles, int maxThreads)
+{
+	// every puzzle is solved on its own with all threads, the speedup is against 1 thread
+	std::cout << "threads    total ms    speedup" << std::endl;
+
+	double baseline = 0.0;
+	std::uint8_t solution[SudokuSolver::Cells];
+
+	for (int threads = 1; threads <= maxThreads; threads++)
+	{
+		ParallelSudokuSolver<3, 3> solver(threads);
+		auto start = std::chrono::steady_clock::now();
+
+		for (const Puzzle& puzzle : puzzles)
+			solver.Solve(puzzle.data(), solution);
+
+		double total = Milliseconds(start);
+		if (threads == 1)
+			baseline = total;
+
+		std::cout << std::setw(7) << threads << std::setw(12) << total << std::setw(10) << baseline / total << "x" << std::endl;
+	}
+}
+
+void BenchmarkGenerator(int maxThreads)
+{
+	// minimal puzzles with a unique solution, the slowest target for the generator
+	const std::size_t count = 1000;
+	std::vector<std::uint8_t> puzzles(count * SudokuSolver::Cells);
+
+	std::cout << std::endl << "generator threads    puzzles / s" << std::endl;
+
+	for (int threads = 1; threads <= maxThreads; threads *= 2)
+	{
+		auto start = std::chrono::steady_clock::now();
+		GeneratePuzzles<3, 3>(puzzles.data(), nullptr, count, 0, Symmetry::None, 1, threads);
+		double total = Milliseconds(start);
+
+		std::cout << std::setw(17) << threads << std::setw(15) << 1000.0 * count / total << std::endl;
+	}
+}
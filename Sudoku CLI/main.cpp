@@ -0,0 +1,353 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "BatchSolver.h"
+#include "MappedFile.h"
+#include "PuzzlePack.h"
+#include "SolutionCache.h"
+#include "SudokuSolver.h"
+
+// usage : "Sudoku CLI" input [-o output] [-t threads] [-l milliseconds per block] [-c cache entries]
+//         "Sudoku CLI" input -pack output [-s]		text to binary puzzle pack, -s stores the solutions and whether each is unique too
+//         "Sudoku CLI" input -unpack output			binary puzzle pack to text
+// input : a 9x9 puzzle pack, or one 9x9 puzzle per line, 81 characters with '.' or '0' for empty cells, anything after them is ignored
+// output : one line per input puzzle, in the same order : the solution, or the puzzle followed by invalid / unsolvable / timeout
+
+const int Cells = SudokuSolver::Cells;
+
+// puzzles solved between two writes, about 5 MB of puzzles
+const std::size_t BlockSize = 1 << 16;
+
+struct Block
+{
+	std::vector<std::uint8_t> Puzzles;
+	std::vector<SolveStatus> Status;
+	std::vector<bool> Malformed;		// line too short or with other characters than digits and '.'
+	std::vector<const char*> Lines;		// start of every line in the mapped file
+	const char* End;					// end of the mapped file
+	std::vector<char> Text;				// output lines
+	std::size_t Count;
+};
+
+struct Totals
+{
+	std::size_t Solved = 0, Invalid = 0, Unsolvable = 0, Timeout = 0;
+};
+
+const char* ParseBlock(const char* text, const char* end, Block& block);
+std::uint64_t ReadBlock(const PuzzlePack& pack, std::uint64_t first, Block& block);
+std::size_t GatherPuzzles(Block& block);
+void ScatterPuzzles(Block& block, std::size_t count);
+void SolveCached(Block& block, std::size_t count, SolutionCache& cache, int threads, const SolveLimits& limits);
+void FormatBlock(Block& block, Totals& totals);
+
+int main(int argc, char* argv[])
+{
+	std::string input, output, pack, unpack;
+	bool solutions = false;
+	int threads = 0;
+	long long limit = 0;
+	std::size_t cacheSize = 0;
+
+	// a number that does not parse leaves no input, so the usage is printed
+	try
+	{
+		for (int i = 1; i < argc; i++)
+		{
+			std::string arg = argv[i];
+
+			if (arg == "-o" && i + 1 < argc)
+				output = argv[++i];
+			else if (arg == "-t" && i + 1 < argc)
+				threads = std::stoi(argv[++i]);
+			else if (arg == "-l" && i + 1 < argc)
+				limit = std::stoll(argv[++i]);
+			else if (arg == "-c" && i + 1 < argc)
+				cacheSize = (std::size_t)std::stoull(argv[++i]);
+			else if (arg == "-pack" && i + 1 < argc)
+				pack = argv[++i];
+			else if (arg == "-unpack" && i + 1 < argc)
+				unpack = argv[++i];
+			else if (arg == "-s")
+				solutions = true;
+			else
+				input = arg;
+		}
+	}
+	catch (const std::exception&)
+	{
+		input.clear();
+	}
+
+	if (input.empty())
+	{
+		std::fprintf(stderr, "usage : %s input [-o output] [-t threads] [-l milliseconds per block] [-c cache entries]\n", argv[0]);
+		std::fprintf(stderr, "        %s input -pack output [-s]\n", argv[0]);
+		std::fprintf(stderr, "        %s input -unpack output\n", argv[0]);
+		return -1;
+	}
+
+	if (!pack.empty() || !unpack.empty())
+	{
+		long long malformedLine = 0;
+		long long count = (pack.empty() ? PackToText(input, unpack) : TextToPack(input, pack, solutions, &malformedLine));
+		if (count < 0)
+		{
+			if (malformedLine > 0)
+				std::fprintf(stderr, "ERROR::CLI: Malformed puzzle on line %lld of %s\n", malformedLine, input.c_str());
+			else
+				std::fprintf(stderr, "ERROR::CLI: Failed to convert %s\n", input.c_str());
+			return -1;
+		}
+
+		std::fprintf(stderr, "%lld puzzles converted\n", count);
+		return 0;
+	}
+
+	// puzzle packs are read as they are, anything else as text
+	PuzzlePack puzzles;
+	MappedFile file;
+	bool binary = puzzles.Open(input, FileAccess::Sequential);
+
+	if (binary && (puzzles.GetBoxHeight() != 3 || puzzles.GetBoxWidth() != 3))
+	{
+		std::fprintf(stderr, "ERROR::CLI: %s does not hold 9x9 puzzles\n", input.c_str());
+		return -1;
+	}
+
+	if (!binary && !file.Open(input))
+	{
+		std::fprintf(stderr, "ERROR::CLI: Failed to map %s\n", input.c_str());
+		return -1;
+	}
+
+	FILE* out = (output.empty() ? stdout : std::fopen(output.c_str(), "wb"));
+	if (!out)
+	{
+		std::fprintf(stderr, "ERROR::CLI: Failed to open %s\n", output.c_str());
+		return -1;
+	}
+	std::setvbuf(out, nullptr, _IOFBF, 1 << 20);
+
+	auto start = std::chrono::steady_clock::now();
+
+	// one block is solved while the one before it is formatted and written
+	Block blocks[2];
+	std::future<void> writer;
+	Totals totals;
+
+	// repeated puzzles, also relabeled or reflected ones, are only solved once
+	SolutionCache cache(cacheSize);
+
+	const char* text = file.Data();
+	const char* end = text + file.Size();
+	std::uint64_t next = 0;
+
+	for (int current = 0; (binary ? next < puzzles.GetCount() : text < end); current ^= 1)
+	{
+		Block& block = blocks[current];
+		if (binary)
+			next = ReadBlock(puzzles, next, block);
+		else
+			text = ParseBlock(text, end, block);
+
+		SolveLimits limits;
+		if (limit > 0)
+			limits.Deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(limit);
+
+		// malformed lines are neither solved nor cached
+		std::size_t count = GatherPuzzles(block);
+
+		if (cacheSize > 0)
+			SolveCached(block, count, cache, threads, limits);
+		else
+			SolveBatch<3, 3>(block.Puzzles.data(), block.Puzzles.data(), block.Status.data(), count, threads, limits);
+
+		ScatterPuzzles(block, count);
+
+		if (writer.valid())
+			writer.get();
+
+		writer = std::async(std::launch::async, [&block, &totals, out]()
+		{
+			FormatBlock(block, totals);
+			std::fwrite(block.Text.data(), 1, block.Text.size(), out);
+		});
+	}
+
+	if (writer.valid())
+		writer.get();
+
+	std::fflush(out);
+	if (out != stdout)
+		std::fclose(out);
+
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	std::size_t count = totals.Solved + totals.Invalid + totals.Unsolvable + totals.Timeout;
+
+	std::fprintf(stderr, "%zu puzzles in %.3f s (%.0f / s) : %zu solved, %zu invalid, %zu unsolvable, %zu timeout\n",
+		count, seconds, count / (seconds > 0.0 ? seconds : 1.0), totals.Solved, totals.Invalid, totals.Unsolvable, totals.Timeout);
+
+	if (cacheSize > 0)
+		std::fprintf(stderr, "cache : %llu hits, %llu misses, %zu entries\n",
+			(unsigned long long)cache.GetHits(), (unsigned long long)cache.GetMisses(), cache.GetSize());
+
+	return 0;
+}
+
+// reads up to BlockSize lines straight from the mapped file into the puzzle buffer
+// returns where the next block starts
+const char* ParseBlock(const char* text, const char* end, Block& block)
+{
+	block.Puzzles.resize(BlockSize * Cells);
+	block.Status.resize(BlockSize);
+	block.Malformed.assign(BlockSize, false);
+	block.Lines.resize(BlockSize);
+	block.End = end;
+	block.Count = 0;
+
+	while (text < end && block.Count < BlockSize)
+	{
+		const char* newline = (const char*)std::memchr(text, '\n', end - text);
+		const char* lineEnd = (newline ? newline : end);
+
+		block.Lines[block.Count] = text;
+		block.Malformed[block.Count] = !ParsePuzzleLine(text, lineEnd, &block.Puzzles[block.Count * Cells]);
+		block.Count++;
+		text = (newline ? newline + 1 : end);
+	}
+
+	return text;
+}
+
+// unpacks up to BlockSize puzzles from a puzzle pack, none of them is malformed
+// returns the first puzzle of the next block
+std::uint64_t ReadBlock(const PuzzlePack& pack, std::uint64_t first, Block& block)
+{
+	block.Count = (std::size_t)std::min<std::uint64_t>(BlockSize, pack.GetCount() - first);
+	block.Puzzles.resize(BlockSize * Cells);
+	block.Status.resize(BlockSize);
+	block.Malformed.assign(BlockSize, false);
+	block.Lines.assign(BlockSize, nullptr);
+	block.End = nullptr;
+
+	pack.ReadPuzzles(first, block.Count, block.Puzzles.data());
+
+	return first + block.Count;
+}
+
+// moves the well-formed puzzles of a block to its front, returns how many there are
+std::size_t GatherPuzzles(Block& block)
+{
+	std::size_t count = 0;
+	for (std::size_t i = 0; i < block.Count; i++)
+	{
+		if (block.Malformed[i])
+			continue;
+
+		if (count != i)
+			std::memcpy(&block.Puzzles[count * Cells], &block.Puzzles[i * Cells], Cells);
+		count++;
+	}
+
+	return count;
+}
+
+// moves the first count boards and their status back to the lines GatherPuzzles took them from
+// going backwards, every board lands at or after where it is
+void ScatterPuzzles(Block& block, std::size_t count)
+{
+	for (std::size_t i = block.Count; i-- > 0 && count > 0;)
+	{
+		if (block.Malformed[i])
+			continue;
+
+		count--;
+		if (count != i)
+		{
+			std::memcpy(&block.Puzzles[i * Cells], &block.Puzzles[count * Cells], Cells);
+			block.Status[i] = block.Status[count];
+		}
+	}
+}
+
+// solves the first count puzzles of a block in place through the cache, the workers take puzzles in chunks
+void SolveCached(Block& block, std::size_t count, SolutionCache& cache, int threads, const SolveLimits& limits)
+{
+	const std::size_t Chunk = 256;
+
+	if (threads <= 0)
+		threads = std::max(1, (int)std::thread::hardware_concurrency());
+
+	std::atomic<std::size_t> next(0);
+	auto work = [&]()
+	{
+		SudokuSolver solver;
+		solver.SetLimits(limits);
+
+		for (std::size_t first = next.fetch_add(Chunk); first < count; first = next.fetch_add(Chunk))
+			for (std::size_t i = first; i < std::min(first + Chunk, count); i++)
+				block.Status[i] = cache.Solve(&block.Puzzles[i * Cells], &block.Puzzles[i * Cells], solver);
+	};
+
+	std::vector<std::thread> workers;
+	for (int i = 1; i < threads; i++)
+		workers.emplace_back(work);
+	work();
+
+	for (std::thread& worker : workers)
+		worker.join();
+}
+
+// writes the output lines of a block and counts the results
+void FormatBlock(Block& block, Totals& totals)
+{
+	static const char* Reasons[] = { "", " invalid", " unsolvable", " timeout" };
+
+	block.Text.resize(block.Count * (Cells + 12));
+	char* line = block.Text.data();
+
+	for (std::size_t i = 0; i < block.Count; i++)
+	{
+		SolveStatus status = (block.Malformed[i] ? SolveStatus::Invalid : block.Status[i]);
+		const std::uint8_t* board = &block.Puzzles[i * Cells];
+
+		if (block.Malformed[i])
+		{
+			// echo the line as it was, without its line break
+			for (const char* c = block.Lines[i]; c < block.Lines[i] + Cells && c < block.End && *c != '\n' && *c != '\r'; c++)
+				*line++ = *c;
+		}
+		else
+		{
+			// unsolved boards still hold the givens
+			for (int j = 0; j < Cells; j++)
+				*line++ = (board[j] ? (char)('0' + board[j]) : '.');
+		}
+
+		const char* reason = Reasons[(int)status];
+		std::size_t length = std::strlen(reason);
+		std::memcpy(line, reason, length);
+		line += length;
+		*line++ = '\n';
+
+		if (status == SolveStatus::Solved)
+			totals.Solved++;
+		else if (status == SolveStatus::Invalid)
+			totals.Invalid++;
+		else if (status == SolveStatus::Unsolvable)
+			totals.Unsolvable++;
+		else
+			totals.Timeout++;
+	}
+
+	block.Text.resize(line - block.Text.data());
+}
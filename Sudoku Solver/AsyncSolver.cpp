@@ -0,0 +1,68 @@
+#include "AsyncSolver.h"
+
+#include <algorithm>
+#include <chrono>
+
+template <int BoxHeight, int BoxWidth>
+AsyncSudokuSolver<BoxHeight, BoxWidth>::~AsyncSudokuSolver()
+{
+	Cancel();
+
+	if (Result.valid())
+		Result.wait();
+}
+
+template <int BoxHeight, int BoxWidth>
+bool AsyncSudokuSolver<BoxHeight, BoxWidth>::Start(const std::uint8_t* puzzle, const SolveLimits& limits)
+{
+	if (IsRunning())
+		return false;
+
+	std::copy(puzzle, puzzle + Cells, Puzzle);
+	Cancelled = false;
+
+	SolveLimits bounded = limits;
+	bounded.Cancel = &Cancelled;
+	Solver.SetLimits(bounded);
+
+	// the worker owns Solver, Puzzle and Solution until the future is ready
+	Result = std::async(std::launch::async, [this]() { return Solver.Solve(Puzzle, Solution); });
+	return true;
+}
+
+template <int BoxHeight, int BoxWidth>
+bool AsyncSudokuSolver<BoxHeight, BoxWidth>::IsRunning()
+{
+	return Result.valid();
+}
+
+template <int BoxHeight, int BoxWidth>
+bool AsyncSudokuSolver<BoxHeight, BoxWidth>::Poll(std::uint8_t* solution, SolveStatus& status)
+{
+	if (!Result.valid() || Result.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+		return false;
+
+	// get() releases the future, the next Start is allowed from here on
+	status = Result.get();
+	std::copy(Solution, Solution + Cells, solution);
+	return true;
+}
+
+template <int BoxHeight, int BoxWidth>
+void AsyncSudokuSolver<BoxHeight, BoxWidth>::Cancel()
+{
+	Cancelled = true;
+}
+
+template <int BoxHeight, int BoxWidth>
+const SolveStats& AsyncSudokuSolver<BoxHeight, BoxWidth>::GetStats()
+{
+	return Solver.GetStats();
+}
+
+// board geometries compiled into the solver
+template class AsyncSudokuSolver<3, 3>;
+template class AsyncSudokuSolver<4, 4>;
+template class AsyncSudokuSolver<5, 5>;
+template class AsyncSudokuSolver<2, 3>;
+template class AsyncSudokuSolver<3, 4>;
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <future>
+
+#include "SudokuSolver.h"
+
+// runs one solve at a time on a worker thread, so the render loop never waits for the search
+// the caller polls for the result once per frame
+// instantiated in AsyncSolver.cpp for the same geometries as BasicSudokuSolver
+template <int BoxHeight, int BoxWidth>
+class AsyncSudokuSolver
+{
+public:
+	static const int Size = BoxHeight * BoxWidth;
+	static const int Cells = Size * Size;
+
+	// destructor : cancels the running solve and waits for the worker
+	~AsyncSudokuSolver();
+
+	// copies the puzzle (row by row, 0 marks an empty cell) and starts solving it
+	// limits.Cancel is replaced by Cancel(), false if a solve is already running
+	bool Start(const std::uint8_t* puzzle, const SolveLimits& limits = SolveLimits());
+
+	// true from Start until Poll hands back the result
+	bool IsRunning();
+
+	// never blocks : false while the worker is busy, otherwise fills solution and status once
+	bool Poll(std::uint8_t* solution, SolveStatus& status);
+
+	// the running solve stops soon after with SolveStatus::BudgetExceeded
+	void Cancel();
+
+	// counters of the solve handed back by the last Poll
+	const SolveStats& GetStats();
+
+private:
+	BasicSudokuSolver<BoxHeight, BoxWidth> Solver;		// only used by the worker while a solve runs
+	std::uint8_t Puzzle[Cells], Solution[Cells];
+
+	std::future<SolveStatus> Result;
+	std::atomic<bool> Cancelled;
+};
@@ -0,0 +1,71 @@
+#include "BatchSolver.h"
+#include "SudokuSolver.h"
+#include "LaneSolver.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// puzzles handed to a worker at a time, so uneven puzzles still balance out
+static const std::size_t ChunkSize = 64;
+
+template <int BoxHeight, int BoxWidth>
+void SolveBatch(const std::uint8_t* puzzles, std::uint8_t* solutions, SolveStatus* status, std::size_t count, int threads, const SolveLimits& limits, SolveStats* stats)
+{
+	typedef BasicSudokuSolver<BoxHeight, BoxWidth> Solver;
+
+	if (threads <= 0)
+		threads = std::max(1u, std::thread::hardware_concurrency());
+
+	// no point in starting workers that would never get a chunk
+	threads = (int)std::min<std::size_t>(threads, (count + ChunkSize - 1) / ChunkSize);
+
+	std::atomic<std::size_t> next(0);
+
+	auto worker = [&]()
+	{
+		// solver state is private to the worker
+		Solver solver;
+		solver.SetLimits(limits);
+
+		for (std::size_t first = next.fetch_add(ChunkSize); first < count; first = next.fetch_add(ChunkSize))
+		{
+			std::size_t last = std::min(first + ChunkSize, count);
+
+			// 9x9 chunks go through the SIMD lane solver when the CPU has vector units
+			if constexpr (BoxHeight == 3 && BoxWidth == 3)
+			{
+				if (DetectSimdLevel() != SimdLevel::Scalar && !stats)
+				{
+					SolveLanes(puzzles + first * Solver::Cells, solutions + first * Solver::Cells, status + first, last - first, solver, DetectSimdLevel());
+					continue;
+				}
+			}
+
+			for (std::size_t i = first; i < last; i++)
+			{
+				status[i] = solver.Solve(puzzles + i * Solver::Cells, solutions + i * Solver::Cells);
+				if (stats)
+					stats[i] = solver.GetStats();
+			}
+		}
+	};
+
+	// the calling thread is one of the workers
+	std::vector<std::thread> workers;
+	for (int i = 1; i < threads; i++)
+		workers.emplace_back(worker);
+
+	worker();
+
+	for (std::thread& thread : workers)
+		thread.join();
+}
+
+// board geometries with a batch entry point
+template void SolveBatch<3, 3>(const std::uint8_t*, std::uint8_t*, SolveStatus*, std::size_t, int, const SolveLimits&, SolveStats*);
+template void SolveBatch<4, 4>(const std::uint8_t*, std::uint8_t*, SolveStatus*, std::size_t, int, const SolveLimits&, SolveStats*);
+template void SolveBatch<5, 5>(const std::uint8_t*, std::uint8_t*, SolveStatus*, std::size_t, int, const SolveLimits&, SolveStats*);
+template void SolveBatch<2, 3>(const std::uint8_t*, std::uint8_t*, SolveStatus*, std::size_t, int, const SolveLimits&, SolveStats*);
+template void SolveBatch<3, 4>(const std::uint8_t*, std::uint8_t*, SolveStatus*, std::size_t, int, const SolveLimits&, SolveStats*);
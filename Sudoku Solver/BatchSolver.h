@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "SudokuEngine.h"
+#include "SolveStats.h"
+
+// solves count puzzles stored back to back in one buffer
+// every puzzle is BoxHeight * BoxWidth squared bytes, row by row, 0 marks an empty cell
+// solutions has the same layout and may be the puzzles buffer itself, status gets one entry per puzzle
+// the work is shared by threads workers (0 = one per hardware thread), each with its own solver
+// limits bound every puzzle (MaxNodes) and the whole batch (Deadline, Cancel) : puzzles cut short get SolveStatus::BudgetExceeded
+// stats (optional) gets the counters of every puzzle, such batches skip the SIMD lane solver
+template <int BoxHeight, int BoxWidth>
+void SolveBatch(const std::uint8_t* puzzles, std::uint8_t* solutions, SolveStatus* status, std::size_t count, int threads = 0,
+	const SolveLimits& limits = SolveLimits(), SolveStats* stats = nullptr);
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// index of the lowest set bit (mask must not be 0)
+inline int CountTrailingZeros(std::uint32_t mask)
+{
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward(&index, mask);
+	return (int)index;
+#else
+	return __builtin_ctz(mask);
+#endif
+}
+
+// number of set bits
+inline int PopCount(std::uint32_t mask)
+{
+#ifdef _MSC_VER
+	return (int)__popcnt(mask);
+#else
+	return __builtin_popcount(mask);
+#endif
+}
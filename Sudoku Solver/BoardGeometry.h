@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+
+// compile-time lookup tables for a board made of BoxHeight x BoxWidth boxes
+// cells are numbered row by row from 0, rows / columns / squares from 0
+template <int BoxHeight, int BoxWidth>
+struct BoardGeometry
+{
+	static constexpr int Size = BoxHeight * BoxWidth;
+	static constexpr int Cells = Size * Size;
+	static constexpr int Units = 3 * Size;		// rows, then columns, then squares
+
+	// smallest type that holds a cell number
+	typedef typename std::conditional<(Cells <= 256), std::uint8_t, std::uint16_t>::type CellIndex;
+
+	std::uint8_t Row[Cells] = {};
+	std::uint8_t Column[Cells] = {};
+	std::uint8_t Square[Cells] = {};
+
+	// cells of every row, column and square
+	CellIndex UnitCells[Units][Size] = {};
+
+	constexpr BoardGeometry()
+	{
+		for (int cell = 0; cell < Cells; cell++)
+		{
+			int row = cell / Size;
+			int column = cell % Size;
+			int top = row / BoxHeight * BoxHeight;
+			int left = column / BoxWidth * BoxWidth;
+
+			Row[cell] = (std::uint8_t)row;
+			Column[cell] = (std::uint8_t)column;
+			Square[cell] = (std::uint8_t)(top + column / BoxWidth);
+
+			int index = (row - top) * BoxWidth + column - left;		// position inside the square
+			UnitCells[row][column] = (CellIndex)cell;
+			UnitCells[Size + column][row] = (CellIndex)cell;
+			UnitCells[2 * Size + Square[cell]][index] = (CellIndex)cell;
+		}
+	}
+};
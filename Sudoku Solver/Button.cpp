@@ -51,6 +51,11 @@ void Button::Render(TextRenderer* TextRender, glm::vec2 textOffset)
 	TextRender->RenderText(Text, Position.x + textOffset.x, Position.y + textOffset.y, 1.0f);
 }
 
+void Button::SetText(std::string text)
+{
+	Text = text;
+}
+
 void Button::SetLeftMouse(bool press)
 {
 	if (press && MouseInButtonRange)
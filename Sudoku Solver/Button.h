@@ -20,6 +20,8 @@ public:
 
 	void Render(TextRenderer* TextRender, glm::vec2 textOffset);
 
+	void SetText(std::string text);
+
 	bool IsClicked();
 
 private:
@@ -0,0 +1,329 @@
+#include "CanonicalForm.h"
+#include "BoardGeometry.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+static constexpr BoardGeometry<3, 3> Layout = BoardGeometry<3, 3>();
+
+// column orders that keep stacks together : stack order * order inside every stack, 6 * 6 * 6 * 6
+const int ColumnOrders = 1296;
+
+static const std::uint8_t Permutations[6][3] = {
+	{ 0, 1, 2 }, { 0, 2, 1 }, { 1, 0, 2 }, { 1, 2, 0 }, { 2, 0, 1 }, { 2, 1, 0 }
+};
+
+struct CanonicalTables
+{
+	std::uint8_t Columns[ColumnOrders][9];
+
+	// the first canonical row only depends on where the clues of a row go (its values are relabeled 1, 2, 3, ...)
+	// MinMask[mask] is the smallest clue mask any column order gives, the first column being the highest bit,
+	// and MinOrders[First[mask]] to MinOrders[First[mask + 1]] the column orders that give it
+	std::uint16_t MinMask[512];
+	int First[513];
+	std::vector<std::uint16_t> MinOrders;
+
+	CanonicalTables()
+	{
+		for (int order = 0; order < ColumnOrders; order++)
+		{
+			const std::uint8_t* stacks = Permutations[order / 216];
+			const std::uint8_t* inside[3] = { Permutations[order / 36 % 6], Permutations[order / 6 % 6], Permutations[order % 6] };
+
+			for (int i = 0; i < 9; i++)
+				Columns[order][i] = (std::uint8_t)(3 * stacks[i / 3] + inside[i / 3][i % 3]);
+		}
+
+		for (int mask = 0; mask < 512; mask++)
+		{
+			MinMask[mask] = 511;
+			for (int order = 0; order < ColumnOrders; order++)
+				MinMask[mask] = std::min(MinMask[mask], Permute(mask, order));
+
+			First[mask] = (int)MinOrders.size();
+			for (int order = 0; order < ColumnOrders; order++)
+				if (Permute(mask, order) == MinMask[mask])
+					MinOrders.push_back((std::uint16_t)order);
+		}
+		First[512] = (int)MinOrders.size();
+	}
+
+	std::uint16_t Permute(int mask, int order) const
+	{
+		std::uint16_t result = 0;
+		for (int i = 0; i < 9; i++)
+			result = (std::uint16_t)((result << 1) | ((mask >> (8 - Columns[order][i])) & 1));
+		return result;
+	}
+};
+
+static const CanonicalTables& Tables()
+{
+	static const CanonicalTables tables;
+	return tables;
+}
+
+// a partial canonical form : the first rows are placed, the columns are fixed
+struct Candidate
+{
+	std::uint8_t Transpose;
+	std::uint8_t Bands;				// bands already used, one bit each
+	std::uint16_t Order;			// column order
+	std::uint8_t Rows[9];
+	std::uint8_t Labels[10];
+	std::uint8_t NextLabel;
+};
+
+static bool IsValidPuzzle(const std::uint8_t* puzzle)
+{
+	for (int unit = 0; unit < 27; unit++)
+	{
+		int seen = 0;
+		for (int i = 0; i < 9; i++)
+		{
+			int value = puzzle[Layout.UnitCells[unit][i]];
+			if (value > 9 || (value && (seen >> value & 1)))
+				return false;
+			seen |= 1 << value;
+		}
+	}
+
+	return true;
+}
+
+// empty lines can be swapped without changing anything, so of the orders that only differ there one is enough :
+// the one with the empty columns of every stack, and the empty stacks, in their original order
+static bool SkipColumnOrder(const std::uint8_t* columns, int empty)
+{
+	int lastStack = -1;
+	for (int position = 0; position < 9; position += 3)
+	{
+		int stack = columns[position] / 3;
+		if ((empty >> (3 * stack) & 7) == 7)
+		{
+			if (stack < lastStack)
+				return true;
+			lastStack = stack;
+		}
+
+		int lastColumn = -1;
+		for (int i = position; i < position + 3; i++)
+			if (empty >> columns[i] & 1)
+			{
+				if (columns[i] < lastColumn)
+					return true;
+				lastColumn = columns[i];
+			}
+	}
+
+	return false;
+}
+
+// the same for rows : an empty row is only placed if no earlier empty row of its band is left,
+// and starts a band only if no earlier empty band is left
+static bool SkipRow(const std::uint8_t* rows, int k, int bands, int row, int empty)
+{
+	if (!(empty >> row & 1))
+		return false;
+
+	int band = row / 3;
+	for (int other = 3 * band; other < row; other++)
+		if ((empty >> other & 1) && std::find(rows + k - k % 3, rows + k, other) == rows + k)
+			return true;
+
+	if (k % 3 == 0 && (empty >> (3 * band) & 7) == 7)
+		for (int other = 0; other < band; other++)
+			if (!(bands >> other & 1) && (empty >> (3 * other) & 7) == 7)
+				return true;
+
+	return false;
+}
+
+bool Canonicalize(const std::uint8_t* puzzle, std::uint8_t* canonical, SudokuTransform& transform)
+{
+	if (!IsValidPuzzle(puzzle))
+		return false;
+
+	const CanonicalTables& tables = Tables();
+
+	std::uint8_t grids[2][81];
+	std::uint16_t masks[2][9] = {};
+	int emptyRows[2] = { 511, 511 };		// one bit per row of either orientation, the first row in the lowest bit
+
+	for (int cell = 0; cell < 81; cell++)
+	{
+		int row = cell / 9, column = cell % 9;
+		grids[0][cell] = puzzle[cell];
+		grids[1][column * 9 + row] = puzzle[cell];
+
+		if (puzzle[cell])
+		{
+			masks[0][row] |= 1 << (8 - column);
+			masks[1][column] |= 1 << (8 - row);
+			emptyRows[0] &= ~(1 << row);
+			emptyRows[1] &= ~(1 << column);
+		}
+	}
+
+	// first row : every orientation, row and column order whose clue mask is the smallest one
+	std::uint16_t best = 511;
+	for (int t = 0; t < 2; t++)
+		for (int row = 0; row < 9; row++)
+			best = std::min(best, tables.MinMask[masks[t][row]]);
+
+	// reused between calls, the first rows of sparse puzzles can leave thousands of candidates
+	static thread_local std::vector<Candidate> current, next;
+	current.clear();
+
+	for (int t = 0; t < 2; t++)
+		for (int row = 0; row < 9; row++)
+		{
+			int mask = masks[t][row];
+			if (tables.MinMask[mask] != best || SkipRow(nullptr, 0, 0, row, emptyRows[t]))
+				continue;
+
+			for (int i = tables.First[mask]; i < tables.First[mask + 1]; i++)
+			{
+				// the columns of one orientation are the rows of the other
+				int order = tables.MinOrders[i];
+				if (emptyRows[1 - t] && SkipColumnOrder(tables.Columns[order], emptyRows[1 - t]))
+					continue;
+
+				Candidate candidate = {};
+				candidate.Transpose = (std::uint8_t)t;
+				candidate.Bands = (std::uint8_t)(1 << (row / 3));
+				candidate.Order = (std::uint16_t)order;
+				candidate.Rows[0] = (std::uint8_t)row;
+				candidate.NextLabel = 1;
+
+				for (int i = 0; i < 9; i++)
+				{
+					int value = grids[t][row * 9 + tables.Columns[order][i]];
+					if (value)
+						candidate.Labels[value] = candidate.NextLabel++;
+				}
+
+				current.push_back(candidate);
+			}
+		}
+
+	// next rows : only the candidates whose rows so far equal the smallest prefix can still give the minimum
+	for (int k = 1; k < 9; k++)
+	{
+		std::uint8_t bestRow[9];
+		bool found = false;
+		next.clear();
+
+		for (const Candidate& candidate : current)
+		{
+			const std::uint8_t* grid = grids[candidate.Transpose];
+			const std::uint8_t* columns = tables.Columns[candidate.Order];
+
+			for (int row = 0; row < 9; row++)
+			{
+				// a new band at the start of every band, otherwise a row of the current band not placed yet
+				if (k % 3 == 0)
+				{
+					if (candidate.Bands >> (row / 3) & 1)
+						continue;
+				}
+				else if (row / 3 != candidate.Rows[k - 1] / 3 || row == candidate.Rows[k - 1] || (k % 3 == 2 && row == candidate.Rows[k - 2]))
+					continue;
+
+				if (emptyRows[candidate.Transpose] && SkipRow(candidate.Rows, k, candidate.Bands, row, emptyRows[candidate.Transpose]))
+					continue;
+
+				std::uint8_t labels[10], values[9];
+				std::memcpy(labels, candidate.Labels, 10);
+				int nextLabel = candidate.NextLabel;
+				bool smaller = !found;
+				bool larger = false;
+
+				for (int i = 0; i < 9 && !larger; i++)
+				{
+					int value = grid[row * 9 + columns[i]];
+					if (value && !labels[value])
+						labels[value] = (std::uint8_t)nextLabel++;
+					values[i] = labels[value];
+
+					if (!smaller)
+					{
+						smaller = (values[i] < bestRow[i]);
+						larger = (values[i] > bestRow[i]);
+					}
+				}
+
+				if (larger)
+					continue;
+
+				if (smaller)
+				{
+					std::memcpy(bestRow, values, 9);
+					found = true;
+					next.clear();
+				}
+
+				next.push_back(candidate);
+				Candidate& child = next.back();
+				std::memcpy(child.Labels, labels, 10);
+				child.NextLabel = (std::uint8_t)nextLabel;
+				child.Bands |= 1 << (row / 3);
+				child.Rows[k] = (std::uint8_t)row;
+			}
+		}
+
+		current.swap(next);
+	}
+
+	// every remaining candidate gives the same grid
+	const Candidate& result = current.front();
+	transform.Transpose = (result.Transpose != 0);
+	std::memcpy(transform.Rows, result.Rows, 9);
+	std::memcpy(transform.Columns, tables.Columns[result.Order], 9);
+	std::memcpy(transform.Labels, result.Labels, 10);
+
+	// values missing from the puzzle get the labels left, so solutions map back too
+	int label = result.NextLabel;
+	for (int value = 1; value <= 9; value++)
+		if (!transform.Labels[value])
+			transform.Labels[value] = (std::uint8_t)label++;
+
+	// a grid with hardly any clues can still grow the buffers far beyond what others need
+	const std::size_t KeptCandidates = 4096;
+	if (current.capacity() > KeptCandidates || next.capacity() > KeptCandidates)
+	{
+		std::vector<Candidate>().swap(current);
+		std::vector<Candidate>().swap(next);
+	}
+
+	ApplyTransform(transform, puzzle, canonical);
+	return true;
+}
+
+void ApplyTransform(const SudokuTransform& transform, const std::uint8_t* grid, std::uint8_t* result)
+{
+	for (int i = 0; i < 9; i++)
+		for (int j = 0; j < 9; j++)
+		{
+			int row = transform.Rows[i], column = transform.Columns[j];
+			int cell = (transform.Transpose ? column * 9 + row : row * 9 + column);
+			result[i * 9 + j] = transform.Labels[grid[cell]];
+		}
+}
+
+void InvertTransform(const SudokuTransform& transform, const std::uint8_t* grid, std::uint8_t* result)
+{
+	std::uint8_t values[10] = {};
+	for (int value = 1; value <= 9; value++)
+		values[transform.Labels[value]] = (std::uint8_t)value;
+
+	for (int i = 0; i < 9; i++)
+		for (int j = 0; j < 9; j++)
+		{
+			int row = transform.Rows[i], column = transform.Columns[j];
+			int cell = (transform.Transpose ? column * 9 + row : row * 9 + column);
+			result[cell] = values[grid[i * 9 + j]];
+		}
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+
+// a transform of a 9x9 grid that keeps it valid : an optional transpose, the rows and columns reordered
+// (bands and stacks, then the lines inside them) and the values relabeled
+// result[i * 9 + j] = Labels[source[Rows[i] * 9 + Columns[j]]], source being the grid transposed if Transpose is set
+struct SudokuTransform
+{
+	bool Transpose;
+	std::uint8_t Rows[9];
+	std::uint8_t Columns[9];
+	std::uint8_t Labels[10];		// Labels[0] = 0, empty cells stay empty
+};
+
+// writes the minlex form of a 9x9 puzzle : the smallest row by row string, empty cells lowest, over all
+// 3,359,232 transforms and value relabelings, and a transform that gives it
+// isomorphic puzzles get the same canonical form
+// returns false (nothing written) if the puzzle repeats a value in a row, column or box
+bool Canonicalize(const std::uint8_t* puzzle, std::uint8_t* canonical, SudokuTransform& transform);
+
+void ApplyTransform(const SudokuTransform& transform, const std::uint8_t* grid, std::uint8_t* result);
+
+// undoes ApplyTransform, e.g. maps the solution of a canonical puzzle back to the original puzzle
+void InvertTransform(const SudokuTransform& transform, const std::uint8_t* grid, std::uint8_t* result);
@@ -0,0 +1,167 @@
+#include "CellRenderer.h"
+#include "ResourceManager.h"
+
+#include <algorithm>
+#include <glm/gtc/matrix_transform.hpp>
+
+// character drawn for every value
+static const char Symbols[] = " 123456789ABCDEFGHIJKLMNOP";
+
+CellRenderer::CellRenderer(unsigned int width, unsigned int height, TextRenderer* text)
+	: Text(text), Position(0.0f), SquareSize(0.0f), Scale(1.0f), Size(0), FirstChanged(0), LastChanged(-1)
+{
+	Colors[(int)CellState::Normal] = glm::vec3(1.0f);
+	Colors[(int)CellState::Conflicting] = glm::vec3(1.0f, 0.0f, 0.0f);
+
+	// load and configure shader
+	ResourceManager::LoadShader("shaders/cell.vert", "shaders/cell.frag", nullptr, "cell");
+	ResourceManager::GetShader("cell").Use();
+	ResourceManager::GetShader("cell").SetMatrix4f("projection", glm::ortho(0.0f, (float)width, (float)height, 0.0f));
+	ResourceManager::GetShader("cell").SetInteger("text", 0);
+
+	float QuadVertices[] = {
+		0.0f, 0.0f,
+		0.0f, 1.0f,
+		1.0f, 0.0f,
+
+		0.0f, 1.0f,
+		1.0f, 1.0f,
+		1.0f, 0.0f
+	};
+
+	glGenVertexArrays(1, &VAO);
+	glGenBuffers(1, &QuadVBO);
+	glGenBuffers(1, &InstanceVBO);
+
+	glBindVertexArray(VAO);
+
+	glBindBuffer(GL_ARRAY_BUFFER, QuadVBO);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(QuadVertices), QuadVertices, GL_STATIC_DRAW);
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+
+	// one instance per cell
+	glBindBuffer(GL_ARRAY_BUFFER, InstanceVBO);
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+	glVertexAttribDivisor(1, 1);
+
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindVertexArray(0);
+}
+
+CellRenderer::~CellRenderer()
+{
+	glDeleteBuffers(1, &QuadVBO);
+	glDeleteBuffers(1, &InstanceVBO);
+	glDeleteVertexArrays(1, &VAO);
+}
+
+void CellRenderer::SetLayout(glm::vec2 position, float squareSize, int size, float scale)
+{
+	size = std::min(size, MaxValue);
+
+	if (position != Position || squareSize != SquareSize || scale != Scale)
+	{
+		Position = position;
+		SquareSize = squareSize;
+		Scale = scale;
+		BuildGlyphs();
+	}
+
+	if (size != Size)
+	{
+		// a new board size starts empty
+		Size = size;
+		Instances.resize(size * size);
+		for (int cell = 0; cell < size * size; cell++)
+			Instances[cell] = glm::vec4((float)(cell % size), (float)(cell / size), 0.0f, 0.0f);
+
+		glBindBuffer(GL_ARRAY_BUFFER, InstanceVBO);
+		glBufferData(GL_ARRAY_BUFFER, Instances.size() * sizeof(glm::vec4), Instances.data(), GL_DYNAMIC_DRAW);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+		FirstChanged = 0;
+		LastChanged = -1;
+	}
+}
+
+void CellRenderer::SetCell(int cell, int value, CellState state)
+{
+	if (cell < 0 || cell >= Size * Size || value < 0 || value > Size)
+		return;
+
+	glm::vec4& instance = Instances[cell];
+	if (instance.z == (float)value && instance.w == (float)state)
+		return;
+
+	instance.z = (float)value;
+	instance.w = (float)state;
+
+	if (FirstChanged > LastChanged)
+		FirstChanged = LastChanged = cell;
+	else
+	{
+		FirstChanged = std::min(FirstChanged, cell);
+		LastChanged = std::max(LastChanged, cell);
+	}
+}
+
+void CellRenderer::SetColor(CellState state, glm::vec3 color)
+{
+	Colors[(int)state] = color;
+}
+
+void CellRenderer::Render()
+{
+	if (Size == 0)
+		return;
+
+	// upload the changed cells only
+	if (FirstChanged <= LastChanged)
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, InstanceVBO);
+		glBufferSubData(GL_ARRAY_BUFFER, FirstChanged * sizeof(glm::vec4), (LastChanged - FirstChanged + 1) * sizeof(glm::vec4), &Instances[FirstChanged]);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+		FirstChanged = 0;
+		LastChanged = -1;
+	}
+
+	// the uniforms are set every time, other boards share the shader
+	Shader& shader = ResourceManager::GetShader("cell");
+	shader.Use();
+	shader.SetVector2f("origin", Position);
+	shader.SetFloat("squareSize", SquareSize);
+	shader.SetVector4fv("glyphRects", GlyphRects, MaxValue + 1);
+	shader.SetVector4fv("glyphUVs", GlyphUVs, MaxValue + 1);
+	shader.SetVector3fv("stateColors", Colors, 2);
+
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, Text->GetAtlas());
+	glBindVertexArray(VAO);
+
+	glDrawArraysInstanced(GL_TRIANGLES, 0, 6, Size * Size);
+
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glBindVertexArray(0);
+}
+
+void CellRenderer::BuildGlyphs()
+{
+	int capHeight = Text->GetCapHeight();
+
+	// every glyph is centered in its cell, aligned on the cap height like TextRenderer
+	for (int value = 0; value <= MaxValue; value++)
+	{
+		const Character& ch = Text->GetCharacter(Symbols[value]);
+
+		glm::vec2 size = glm::vec2(ch.Size) * Scale;
+		glm::vec2 offset;
+		offset.x = (SquareSize - size.x) / 2.0f;
+		offset.y = (SquareSize - capHeight * Scale) / 2.0f + (capHeight - ch.Bearing.y) * Scale;
+
+		GlyphRects[value] = (value == 0 ? glm::vec4(0.0f) : glm::vec4(offset, size));
+		GlyphUVs[value] = glm::vec4(ch.TexOrigin, ch.TexOrigin + ch.TexSize);
+	}
+}
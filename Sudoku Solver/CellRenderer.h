@@ -0,0 +1,62 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <vector>
+
+#include "TextRenderer.h"
+
+// how a value is drawn
+enum class CellState
+{
+	Normal,
+	Conflicting		// repeated in its row / column / square
+};
+
+// draws the values of a board of any size in one instanced draw call
+// every cell is an instance (column, row, value, state) of the same quad, the glyphs come from the text atlas
+// only the instances of cells that changed since the last Render are uploaded
+class CellRenderer
+{
+public:
+	// the largest board has 25 values, drawn as 1 - 9 then A - P
+	static const int MaxValue = 25;
+
+	// constructor : text must have its font loaded
+	CellRenderer(unsigned int width, unsigned int height, TextRenderer* text);
+
+	// destructor
+	~CellRenderer();
+
+	// top left corner and cell size in pixels, size rows and columns, glyphs drawn at scale
+	void SetLayout(glm::vec2 position, float squareSize, int size, float scale);
+
+	// cells are numbered row by row, value 0 leaves the cell empty
+	void SetCell(int cell, int value, CellState state = CellState::Normal);
+
+	void SetColor(CellState state, glm::vec3 color);
+
+	void Render();
+
+private:
+	TextRenderer* Text;
+
+	// layout
+	glm::vec2 Position;
+	float SquareSize, Scale;
+	int Size;
+
+	// glyph rectangles inside a cell and their atlas coordinates, per value
+	glm::vec4 GlyphRects[MaxValue + 1];
+	glm::vec4 GlyphUVs[MaxValue + 1];
+	glm::vec3 Colors[2];
+
+	// instance data as last uploaded, and the range of cells changed since
+	std::vector<glm::vec4> Instances;
+	int FirstChanged, LastChanged;
+
+	// render data
+	GLuint VAO, QuadVBO, InstanceVBO;
+	void BuildGlyphs();
+};
@@ -0,0 +1,242 @@
+#include "DancingLinksSolver.h"
+
+DancingLinksSolver::DancingLinksSolver()
+{
+	BuildMatrix();
+	Clear();
+
+	SolutionCount = 0;
+	SolutionLimit = 1;
+}
+
+void DancingLinksSolver::BuildMatrix()
+{
+	// column headers, linked in a circle around the root
+	for (int i = 0; i <= Root; i++)
+	{
+		Nodes[i].Left = (i == 0 ? Root : i - 1);
+		Nodes[i].Right = (i == Root ? 0 : i + 1);
+		Nodes[i].Up = Nodes[i].Down = i;
+		Nodes[i].Column = i;
+		Nodes[i].Row = -1;
+	}
+
+	for (int i = 0; i < ColumnCount; i++)
+		ColumnSize[i] = 0;
+
+	// one row of 4 nodes for every (cell, value)
+	for (int cell = 0; cell < Size * Size; cell++)
+	{
+		int row = cell / Size;
+		int column = cell % Size;
+		int square = row / 3 * 3 + column / 3;
+
+		for (int value = 0; value < Size; value++)
+		{
+			int columns[4] = {
+				cell,
+				Size * Size + row * Size + value,
+				2 * Size * Size + column * Size + value,
+				3 * Size * Size + square * Size + value
+			};
+
+			int first = RowNode(cell, value);
+			for (int k = 0; k < 4; k++)
+			{
+				int node = first + k;
+				int header = columns[k];
+
+				Nodes[node].Left = first + (k + 3) % 4;
+				Nodes[node].Right = first + (k + 1) % 4;
+				Nodes[node].Column = header;
+				Nodes[node].Row = cell * Size + value;
+
+				// append at the bottom of the column
+				Nodes[node].Up = Nodes[header].Up;
+				Nodes[node].Down = header;
+				Nodes[Nodes[header].Up].Down = node;
+				Nodes[header].Up = node;
+				ColumnSize[header]++;
+			}
+		}
+	}
+}
+
+int DancingLinksSolver::RowNode(int cell, int value)
+{
+	return Root + 1 + 4 * (cell * Size + value);
+}
+
+void DancingLinksSolver::Cover(int column)
+{
+	Nodes[Nodes[column].Right].Left = Nodes[column].Left;
+	Nodes[Nodes[column].Left].Right = Nodes[column].Right;
+
+	for (int i = Nodes[column].Down; i != column; i = Nodes[i].Down)
+	{
+		for (int j = Nodes[i].Right; j != i; j = Nodes[j].Right)
+		{
+			Nodes[Nodes[j].Down].Up = Nodes[j].Up;
+			Nodes[Nodes[j].Up].Down = Nodes[j].Down;
+			ColumnSize[Nodes[j].Column]--;
+		}
+	}
+}
+
+void DancingLinksSolver::Uncover(int column)
+{
+	for (int i = Nodes[column].Up; i != column; i = Nodes[i].Up)
+	{
+		for (int j = Nodes[i].Left; j != i; j = Nodes[j].Left)
+		{
+			ColumnSize[Nodes[j].Column]++;
+			Nodes[Nodes[j].Down].Up = j;
+			Nodes[Nodes[j].Up].Down = j;
+		}
+	}
+
+	Nodes[Nodes[column].Right].Left = column;
+	Nodes[Nodes[column].Left].Right = column;
+}
+
+void DancingLinksSolver::CoverRow(int node)
+{
+	// cover the other columns of an already selected row
+	for (int j = Nodes[node].Right; j != node; j = Nodes[j].Right)
+		Cover(Nodes[j].Column);
+}
+
+void DancingLinksSolver::UncoverRow(int node)
+{
+	for (int j = Nodes[node].Left; j != node; j = Nodes[j].Left)
+		Uncover(Nodes[j].Column);
+}
+
+void DancingLinksSolver::Search(int level)
+{
+	if (Nodes[Root].Right == Root)
+	{
+		SolutionCount++;
+		return;
+	}
+
+	// branch on the column with the fewest rows left
+	int column = Nodes[Root].Right;
+	for (int i = Nodes[column].Right; i != Root && ColumnSize[column] > 1; i = Nodes[i].Right)
+		if (ColumnSize[i] < ColumnSize[column])
+			column = i;
+
+	if (ColumnSize[column] == 0)
+		return;
+
+	Cover(column);
+
+	for (int i = Nodes[column].Down; i != column && SolutionCount < SolutionLimit; i = Nodes[i].Down)
+	{
+		Solution[level] = Nodes[i].Row;
+
+		CoverRow(i);
+		Search(level + 1);
+		UncoverRow(i);
+	}
+
+	// the matrix is always restored, so the next Solve starts from the full matrix
+	Uncover(column);
+}
+
+bool DancingLinksSolver::CoverGivens(int* given, int& givenCount)
+{
+	// select the rows of the given values, in row-major order
+	givenCount = 0;
+
+	for (int cell = 0; cell < Size * Size; cell++)
+	{
+		int value = Table[cell / Size][cell % Size];
+		if (value == 0)
+			continue;
+
+		int node = RowNode(cell, value - 1);
+
+		// a column that is already covered means two givens share a constraint
+		for (int k = 0; k < 4; k++)
+		{
+			int header = Nodes[node + k].Column;
+			if (Nodes[Nodes[header].Left].Right != header)
+				return false;
+		}
+
+		Cover(Nodes[node].Column);
+		CoverRow(node);
+		given[givenCount++] = node;
+	}
+
+	return true;
+}
+
+void DancingLinksSolver::UncoverGivens(int* given, int givenCount)
+{
+	// restore the full matrix, in reverse order of covering
+	for (int i = givenCount - 1; i >= 0; i--)
+	{
+		UncoverRow(given[i]);
+		Uncover(Nodes[given[i]].Column);
+	}
+}
+
+bool DancingLinksSolver::Solve()
+{
+	int given[Size * Size];
+	int givenCount;
+
+	SolutionCount = 0;
+	SolutionLimit = 1;
+
+	if (CoverGivens(given, givenCount))
+		Search(0);
+
+	UncoverGivens(given, givenCount);
+
+	// write the picked rows back to the table, one for every empty cell
+	if (SolutionCount > 0)
+		for (int i = 0; i < Size * Size - givenCount; i++)
+			Table[Solution[i] / Size / Size][Solution[i] / Size % Size] = Solution[i] % Size + 1;
+
+	return SolutionCount > 0;
+}
+
+int DancingLinksSolver::CountSolutions(int limit)
+{
+	int given[Size * Size];
+	int givenCount;
+
+	SolutionCount = 0;
+	SolutionLimit = limit;
+
+	if (CoverGivens(given, givenCount))
+		Search(0);
+
+	UncoverGivens(given, givenCount);
+
+	return SolutionCount;
+}
+
+void DancingLinksSolver::SetTableValue(int row, int column, int value)
+{
+	// the value picks a matrix row, so anything outside 0..Size would index past the matrix
+	if (value < 0 || value > Size)
+		return;
+
+	Table[row - 1][column - 1] = value;
+}
+
+int DancingLinksSolver::GetTableValue(int row, int column)
+{
+	return Table[row - 1][column - 1];
+}
+
+void DancingLinksSolver::Clear()
+{
+	for (int i = 0; i < Size; i++)
+		for (int j = 0; j < Size; j++)
+			Table[i][j] = 0;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "SudokuEngine.h"
+
+// exact cover solver : Knuth's Algorithm X over dancing links
+// every (cell, value) pair is a matrix row that covers 4 of the 324 constraint columns
+class DancingLinksSolver : public SudokuEngine
+{
+public:
+	// constructor
+	DancingLinksSolver();
+
+	bool Solve() override;
+	int CountSolutions(int limit) override;
+
+	// values outside 0..Size are ignored
+	void SetTableValue(int row, int column, int value) override;
+	int GetTableValue(int row, int column) override;
+
+	void Clear() override;
+
+private:
+	static const int Size = 9;
+	static const int ColumnCount = 4 * Size * Size;		// cell, row-value, column-value and square-value constraints
+	static const int RowCount = Size * Size * Size;		// one matrix row for every (cell, value)
+	static const int Root = ColumnCount;				// header of the column list
+	static const int NodeCount = ColumnCount + 1 + 4 * RowCount;
+
+	struct Node
+	{
+		int Left, Right, Up, Down;
+		int Column;		// column header of the node
+		int Row;		// matrix row of the node
+	};
+
+	// the whole matrix lives in one preallocated array, built once in the constructor
+	Node Nodes[NodeCount];
+	int ColumnSize[ColumnCount];
+
+	int Table[Size][Size];
+	int Solution[Size * Size];		// matrix rows picked by the search
+	int SolutionCount, SolutionLimit;
+
+	void BuildMatrix();
+	int RowNode(int cell, int value);
+
+	void Cover(int column);
+	void Uncover(int column);
+	void CoverRow(int node);
+	void UncoverRow(int node);
+
+	bool CoverGivens(int* given, int& givenCount);
+	void UncoverGivens(int* given, int givenCount);
+
+	void Search(int level);
+};
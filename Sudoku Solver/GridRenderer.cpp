@@ -0,0 +1,95 @@
+#include "GridRenderer.h"
+#include "ResourceManager.h"
+
+#include <vector>
+
+// line widths in pixels
+const float ThinLine = 1.0f;
+const float ThickLine = 4.0f;
+
+GridRenderer::GridRenderer()
+	: Position(0.0f), SquareSize(0.0f), BoxHeight(0), BoxWidth(0), LayoutChanged(false), VertexCount(0)
+{
+	glGenVertexArrays(1, &VAO);
+	glGenBuffers(1, &VBO);
+
+	glBindVertexArray(VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindVertexArray(0);
+}
+
+GridRenderer::~GridRenderer()
+{
+	glDeleteBuffers(1, &VBO);
+	glDeleteVertexArrays(1, &VAO);
+}
+
+void GridRenderer::SetLayout(glm::vec2 position, float squareSize, int boxHeight, int boxWidth)
+{
+	if (position == Position && squareSize == SquareSize && boxHeight == BoxHeight && boxWidth == BoxWidth)
+		return;
+
+	Position = position;
+	SquareSize = squareSize;
+	BoxHeight = boxHeight;
+	BoxWidth = boxWidth;
+	LayoutChanged = true;
+}
+
+void GridRenderer::Render(glm::vec3 color)
+{
+	if (LayoutChanged)
+		BuildVertices();
+
+	// the vertices are already in screen coordinates
+	ResourceManager::GetShader("line").Use();
+	ResourceManager::GetShader("line").SetMatrix4f("model", glm::mat4(1.0f));
+	ResourceManager::GetShader("line").SetVector3f("color", color);
+
+	glBindVertexArray(VAO);
+	glDrawArrays(GL_TRIANGLES, 0, VertexCount);
+	glBindVertexArray(0);
+}
+
+void GridRenderer::BuildVertices()
+{
+	int size = BoxHeight * BoxWidth;
+	float length = size * SquareSize;
+
+	std::vector<float> vertices;
+	vertices.reserve(2 * (size + 1) * 12);
+
+	// two triangles covering [x0, x1] x [y0, y1]
+	auto quad = [&vertices](float x0, float y0, float x1, float y1)
+	{
+		float corners[] = { x0, y0,  x0, y1,  x1, y0,  x0, y1,  x1, y1,  x1, y0 };
+		vertices.insert(vertices.end(), corners, corners + 12);
+	};
+
+	// every line is centered on its position and the thick ones overlap at the corners
+	for (int i = 0; i <= size; i++)
+	{
+		float half = (i % BoxHeight == 0 ? ThickLine : ThinLine) / 2.0f;
+		float y = Position.y + i * SquareSize;
+		quad(Position.x - half, y - half, Position.x + length + half, y + half);
+	}
+
+	for (int i = 0; i <= size; i++)
+	{
+		float half = (i % BoxWidth == 0 ? ThickLine : ThinLine) / 2.0f;
+		float x = Position.x + i * SquareSize;
+		quad(x - half, Position.y - half, x + half, Position.y + length + half);
+	}
+
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	VertexCount = (GLsizei)(vertices.size() / 2);
+	LayoutChanged = false;
+}
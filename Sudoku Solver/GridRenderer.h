@@ -0,0 +1,34 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+// draws the lines of a board, box borders thicker, as quads in one draw call
+// the vertices live in a static buffer that is only rebuilt when the layout changes
+class GridRenderer
+{
+public:
+	// constructor
+	GridRenderer();
+
+	// destructor
+	~GridRenderer();
+
+	// top left corner and cell size in pixels, the board has BoxHeight * BoxWidth rows and columns
+	void SetLayout(glm::vec2 position, float squareSize, int boxHeight, int boxWidth);
+
+	// uses the "line" shader
+	void Render(glm::vec3 color);
+
+private:
+	// layout
+	glm::vec2 Position;
+	float SquareSize;
+	int BoxHeight, BoxWidth;
+	bool LayoutChanged;
+
+	// render data
+	GLuint VAO, VBO;
+	GLsizei VertexCount;
+	void BuildVertices();
+};
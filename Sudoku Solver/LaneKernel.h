@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstdint>
+
+#include "BoardGeometry.h"
+
+// propagation kernel shared by the lane solvers
+// every lane of a Lanes::Vec holds the 16-bit candidate mask of one cell in one puzzle,
+// so each vector operation advances Lanes::Width 9x9 puzzles at once
+//
+// Lanes provides : Vec, Width, Load, Store, Set, And, Or, Xor, AndNot (~a & b), Dec (x - 1), IsZero (all ones where x == 0), Any
+//
+// candidates is cell-major : candidates[cell * Width + lane]
+// failed gets a nonzero entry for every lane that ran into a contradiction
+template <class Lanes>
+inline void PropagateLanes(std::uint16_t* candidates, std::uint16_t* failed)
+{
+	typedef typename Lanes::Vec Vec;
+	typedef BoardGeometry<3, 3> Geometry;
+	static constexpr Geometry Layout = Geometry();
+
+	const Vec all = Lanes::Set(0x1FF);
+	const Vec zero = Lanes::Set(0);
+
+	Vec cells[Geometry::Cells];
+	for (int cell = 0; cell < Geometry::Cells; cell++)
+		cells[cell] = Lanes::Load(candidates + cell * Lanes::Width);
+
+	Vec bad = zero;
+	Vec changed = all;
+
+	// every round only removes candidates, so the loop always ends
+	while (Lanes::Any(changed))
+	{
+		changed = zero;
+
+		for (int unit = 0; unit < Geometry::Units; unit++)
+		{
+			const typename Geometry::CellIndex* unitCells = Layout.UnitCells[unit];
+
+			// naked singles : values fixed in one cell leave every other cell of the unit
+			Vec seen = zero, twice = zero;
+			for (int k = 0; k < Geometry::Size; k++)
+			{
+				Vec x = cells[unitCells[k]];
+				Vec single = Lanes::And(x, Lanes::IsZero(Lanes::And(x, Lanes::Dec(x))));
+
+				twice = Lanes::Or(twice, Lanes::And(seen, single));
+				seen = Lanes::Or(seen, single);
+			}
+			bad = Lanes::Or(bad, twice);
+
+			Vec once = zero;
+			twice = zero;
+			for (int k = 0; k < Geometry::Size; k++)
+			{
+				Vec x = cells[unitCells[k]];
+				Vec isSingle = Lanes::IsZero(Lanes::And(x, Lanes::Dec(x)));
+				Vec y = Lanes::AndNot(Lanes::AndNot(isSingle, seen), x);
+
+				changed = Lanes::Or(changed, Lanes::Xor(x, y));
+				cells[unitCells[k]] = y;
+
+				twice = Lanes::Or(twice, Lanes::And(once, y));
+				once = Lanes::Or(once, y);
+			}
+
+			// a value with no cell left in the unit
+			bad = Lanes::Or(bad, Lanes::AndNot(once, all));
+
+			// hidden singles : values with a single possible cell in the unit
+			Vec hidden = Lanes::AndNot(twice, once);
+			for (int k = 0; k < Geometry::Size; k++)
+			{
+				Vec x = cells[unitCells[k]];
+				Vec h = Lanes::And(x, hidden);
+				Vec y = Lanes::Or(h, Lanes::And(Lanes::IsZero(h), x));
+
+				// one cell being the only place for two values
+				bad = Lanes::Or(bad, Lanes::And(h, Lanes::Dec(h)));
+
+				changed = Lanes::Or(changed, Lanes::Xor(x, y));
+				cells[unitCells[k]] = y;
+			}
+		}
+
+		// lanes that failed keep shrinking to empty cells, stop them from holding the loop
+		changed = Lanes::And(Lanes::IsZero(bad), changed);
+	}
+
+	for (int cell = 0; cell < Geometry::Cells; cell++)
+	{
+		bad = Lanes::Or(bad, Lanes::IsZero(cells[cell]));
+		Lanes::Store(candidates + cell * Lanes::Width, cells[cell]);
+	}
+
+	Lanes::Store(failed, bad);
+}
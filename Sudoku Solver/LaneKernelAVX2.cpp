@@ -0,0 +1,37 @@
+// x86 only, other targets leave AVX2 out and the lane solver falls back to its scalar loops
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+
+// MSVC takes the intrinsics as they are, GCC needs the instruction set enabled for this file
+#if defined(__GNUC__)
+#pragma GCC target("avx2")
+#endif
+
+#include "LaneKernel.h"
+
+#include <immintrin.h>
+
+// 16 puzzles per 256-bit register
+struct AVX2Lanes
+{
+	typedef __m256i Vec;
+	static const int Width = 16;
+
+	static Vec Load(const std::uint16_t* p) { return _mm256_loadu_si256((const __m256i*)p); }
+	static void Store(std::uint16_t* p, Vec x) { _mm256_storeu_si256((__m256i*)p, x); }
+	static Vec Set(std::uint16_t value) { return _mm256_set1_epi16((short)value); }
+
+	static Vec And(Vec a, Vec b) { return _mm256_and_si256(a, b); }
+	static Vec Or(Vec a, Vec b) { return _mm256_or_si256(a, b); }
+	static Vec Xor(Vec a, Vec b) { return _mm256_xor_si256(a, b); }
+	static Vec AndNot(Vec a, Vec b) { return _mm256_andnot_si256(a, b); }
+	static Vec Dec(Vec x) { return _mm256_sub_epi16(x, _mm256_set1_epi16(1)); }
+	static Vec IsZero(Vec x) { return _mm256_cmpeq_epi16(x, _mm256_setzero_si256()); }
+	static bool Any(Vec x) { return !_mm256_testz_si256(x, x); }
+};
+
+void PropagateAVX2(std::uint16_t* candidates, std::uint16_t* failed)
+{
+	PropagateLanes<AVX2Lanes>(candidates, failed);
+}
+
+#endif
@@ -0,0 +1,37 @@
+// x86 only, other targets leave AVX-512 out and the lane solver falls back to its scalar loops
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+
+// MSVC takes the intrinsics as they are, GCC needs the instruction set enabled for this file
+#if defined(__GNUC__)
+#pragma GCC target("avx512f,avx512bw")
+#endif
+
+#include "LaneKernel.h"
+
+#include <immintrin.h>
+
+// 32 puzzles per 512-bit register
+struct AVX512Lanes
+{
+	typedef __m512i Vec;
+	static const int Width = 32;
+
+	static Vec Load(const std::uint16_t* p) { return _mm512_loadu_si512(p); }
+	static void Store(std::uint16_t* p, Vec x) { _mm512_storeu_si512(p, x); }
+	static Vec Set(std::uint16_t value) { return _mm512_set1_epi16((short)value); }
+
+	static Vec And(Vec a, Vec b) { return _mm512_and_si512(a, b); }
+	static Vec Or(Vec a, Vec b) { return _mm512_or_si512(a, b); }
+	static Vec Xor(Vec a, Vec b) { return _mm512_xor_si512(a, b); }
+	static Vec AndNot(Vec a, Vec b) { return _mm512_andnot_si512(a, b); }
+	static Vec Dec(Vec x) { return _mm512_sub_epi16(x, _mm512_set1_epi16(1)); }
+	static Vec IsZero(Vec x) { return _mm512_movm_epi16(_mm512_cmpeq_epi16_mask(x, _mm512_setzero_si512())); }
+	static bool Any(Vec x) { return _mm512_test_epi16_mask(x, x) != 0; }
+};
+
+void PropagateAVX512(std::uint16_t* candidates, std::uint16_t* failed)
+{
+	PropagateLanes<AVX512Lanes>(candidates, failed);
+}
+
+#endif
@@ -0,0 +1,37 @@
+// x86 only, other targets leave SSE out and the lane solver falls back to its scalar loops
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+
+// MSVC takes the intrinsics as they are, GCC needs the instruction set enabled for this file
+#if defined(__GNUC__)
+#pragma GCC target("sse4.2")
+#endif
+
+#include "LaneKernel.h"
+
+#include <immintrin.h>
+
+// 8 puzzles per 128-bit register
+struct SSELanes
+{
+	typedef __m128i Vec;
+	static const int Width = 8;
+
+	static Vec Load(const std::uint16_t* p) { return _mm_loadu_si128((const __m128i*)p); }
+	static void Store(std::uint16_t* p, Vec x) { _mm_storeu_si128((__m128i*)p, x); }
+	static Vec Set(std::uint16_t value) { return _mm_set1_epi16((short)value); }
+
+	static Vec And(Vec a, Vec b) { return _mm_and_si128(a, b); }
+	static Vec Or(Vec a, Vec b) { return _mm_or_si128(a, b); }
+	static Vec Xor(Vec a, Vec b) { return _mm_xor_si128(a, b); }
+	static Vec AndNot(Vec a, Vec b) { return _mm_andnot_si128(a, b); }
+	static Vec Dec(Vec x) { return _mm_sub_epi16(x, _mm_set1_epi16(1)); }
+	static Vec IsZero(Vec x) { return _mm_cmpeq_epi16(x, _mm_setzero_si128()); }
+	static bool Any(Vec x) { return !_mm_testz_si128(x, x); }
+};
+
+void PropagateSSE(std::uint16_t* candidates, std::uint16_t* failed)
+{
+	PropagateLanes<SSELanes>(candidates, failed);
+}
+
+#endif
@@ -0,0 +1,194 @@
+#include "LaneSolver.h"
+#include "LaneKernel.h"
+#include "BitUtils.h"
+
+#include <algorithm>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// kernels compiled for their own instruction set, see LaneKernel*.cpp, only built for x86 targets
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define SUDOKU_LANE_KERNELS
+void PropagateSSE(std::uint16_t* candidates, std::uint16_t* failed);
+void PropagateAVX2(std::uint16_t* candidates, std::uint16_t* failed);
+void PropagateAVX512(std::uint16_t* candidates, std::uint16_t* failed);
+#endif
+
+// plain loops with the lane semantics of the vector kernels
+struct ScalarLanes
+{
+	static const int Width = 8;
+
+	struct Vec
+	{
+		std::uint16_t Lane[Width];
+	};
+
+	static Vec Load(const std::uint16_t* p) { Vec r; for (int i = 0; i < Width; i++) r.Lane[i] = p[i]; return r; }
+	static void Store(std::uint16_t* p, Vec x) { for (int i = 0; i < Width; i++) p[i] = x.Lane[i]; }
+	static Vec Set(std::uint16_t value) { Vec r; for (int i = 0; i < Width; i++) r.Lane[i] = value; return r; }
+
+	static Vec And(Vec a, Vec b) { for (int i = 0; i < Width; i++) a.Lane[i] &= b.Lane[i]; return a; }
+	static Vec Or(Vec a, Vec b) { for (int i = 0; i < Width; i++) a.Lane[i] |= b.Lane[i]; return a; }
+	static Vec Xor(Vec a, Vec b) { for (int i = 0; i < Width; i++) a.Lane[i] ^= b.Lane[i]; return a; }
+	static Vec AndNot(Vec a, Vec b) { for (int i = 0; i < Width; i++) a.Lane[i] = (std::uint16_t)(~a.Lane[i] & b.Lane[i]); return a; }
+	static Vec Dec(Vec x) { for (int i = 0; i < Width; i++) x.Lane[i]--; return x; }
+	static Vec IsZero(Vec x) { for (int i = 0; i < Width; i++) x.Lane[i] = (x.Lane[i] == 0 ? 0xFFFF : 0); return x; }
+	static bool Any(Vec x) { for (int i = 0; i < Width; i++) if (x.Lane[i]) return true; return false; }
+};
+
+static void PropagateScalar(std::uint16_t* candidates, std::uint16_t* failed)
+{
+	PropagateLanes<ScalarLanes>(candidates, failed);
+}
+
+static SimdLevel QuerySimdLevel()
+{
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+	int info[4];
+	__cpuid(info, 0);
+	int maxLeaf = info[0];
+
+	__cpuid(info, 1);
+	bool sse42 = (info[2] & (1 << 20)) != 0;
+	bool osxsave = (info[2] & (1 << 27)) != 0;
+
+	// the OS has to save the wider registers too
+	unsigned long long xcr0 = osxsave ? _xgetbv(0) : 0;
+	bool ymm = (xcr0 & 0x06) == 0x06;
+	bool zmm = (xcr0 & 0xE6) == 0xE6;
+
+	bool avx2 = false, avx512 = false;
+	if (maxLeaf >= 7)
+	{
+		__cpuidex(info, 7, 0);
+		avx2 = ymm && (info[1] & (1 << 5)) != 0;
+		avx512 = zmm && (info[1] & (1 << 16)) != 0 && (info[1] & (1 << 30)) != 0;		// AVX-512 F and BW
+	}
+
+	if (avx512)
+		return SimdLevel::AVX512;
+	if (avx2)
+		return SimdLevel::AVX2;
+	if (sse42)
+		return SimdLevel::SSE42;
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+	if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw"))
+		return SimdLevel::AVX512;
+	if (__builtin_cpu_supports("avx2"))
+		return SimdLevel::AVX2;
+	if (__builtin_cpu_supports("sse4.2"))
+		return SimdLevel::SSE42;
+#endif
+	return SimdLevel::Scalar;
+}
+
+SimdLevel DetectSimdLevel()
+{
+	static const SimdLevel level = QuerySimdLevel();
+	return level;
+}
+
+int LaneWidth(SimdLevel level)
+{
+	switch (level)
+	{
+	case SimdLevel::SSE42:
+		return 8;
+	case SimdLevel::AVX2:
+		return 16;
+	case SimdLevel::AVX512:
+		return 32;
+	default:
+		return ScalarLanes::Width;
+	}
+}
+
+void SolveLanes(const std::uint8_t* puzzles, std::uint8_t* solutions, SolveStatus* status, std::size_t count, SudokuSolver& fallback, SimdLevel level)
+{
+	const int Cells = SudokuSolver::Cells;
+	const int MaxWidth = 32;
+
+	// without the vector kernels every level runs the scalar loops
+#ifndef SUDOKU_LANE_KERNELS
+	level = SimdLevel::Scalar;
+#endif
+
+	void (*propagate)(std::uint16_t*, std::uint16_t*) = PropagateScalar;
+#ifdef SUDOKU_LANE_KERNELS
+	if (level == SimdLevel::SSE42)
+		propagate = PropagateSSE;
+	else if (level == SimdLevel::AVX2)
+		propagate = PropagateAVX2;
+	else if (level == SimdLevel::AVX512)
+		propagate = PropagateAVX512;
+#endif
+
+	int width = LaneWidth(level);
+	std::uint16_t candidates[Cells * MaxWidth];
+	std::uint16_t failed[MaxWidth];
+
+	for (std::size_t first = 0; first < count; first += width)
+	{
+		int lanes = (int)std::min<std::size_t>(width, count - first);
+
+		// one puzzle per lane, the unused lanes get an empty board
+		for (int cell = 0; cell < Cells; cell++)
+		{
+			for (int lane = 0; lane < width; lane++)
+			{
+				int value = (lane < lanes ? puzzles[(first + lane) * Cells + cell] : 0);
+
+				// out of range values leave the cell without candidates and go to the fallback as invalid
+				if (value == 0)
+					candidates[cell * width + lane] = 0x1FF;
+				else
+					candidates[cell * width + lane] = (value <= 9 ? (std::uint16_t)(1 << (value - 1)) : 0);
+			}
+		}
+
+		propagate(candidates, failed);
+
+		for (int lane = 0; lane < lanes; lane++)
+		{
+			std::size_t index = first + lane;
+
+			bool solved = (failed[lane] == 0);
+			for (int cell = 0; cell < Cells && solved; cell++)
+			{
+				std::uint16_t x = candidates[cell * width + lane];
+				solved = (x & (x - 1)) == 0;
+			}
+
+			// contradictory lanes take the scalar search as they are, so it can tell invalid from unsolvable
+			if (!solved && failed[lane] != 0)
+			{
+				status[index] = fallback.Solve(puzzles + index * Cells, solutions + index * Cells);
+				continue;
+			}
+
+			// stuck lanes keep what the propagation found : its singles become givens of the scalar search
+			if (!solved)
+			{
+				std::uint8_t seeded[Cells], board[Cells];
+				for (int cell = 0; cell < Cells; cell++)
+				{
+					std::uint16_t x = candidates[cell * width + lane];
+					seeded[cell] = ((x & (x - 1)) == 0 ? (std::uint8_t)(CountTrailingZeros(x) + 1) : 0);
+				}
+
+				// an unsolved puzzle still hands back its own givens, not the seeded ones
+				status[index] = fallback.Solve(seeded, board);
+				const std::uint8_t* result = (status[index] == SolveStatus::Solved ? board : puzzles + index * Cells);
+				std::copy(result, result + Cells, solutions + index * Cells);
+				continue;
+			}
+
+			for (int cell = 0; cell < Cells; cell++)
+				solutions[index * Cells + cell] = (std::uint8_t)(CountTrailingZeros(candidates[cell * width + lane]) + 1);
+			status[index] = SolveStatus::Solved;
+		}
+	}
+}
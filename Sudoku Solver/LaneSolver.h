@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "SudokuSolver.h"
+
+// instruction sets the lane solver can run on
+enum class SimdLevel
+{
+	Scalar,		// portable loops, same results as the vector paths
+	SSE42,		// 8 puzzles per register
+	AVX2,		// 16 puzzles per register
+	AVX512		// 32 puzzles per register
+};
+
+// best instruction set of the running CPU, detected once
+SimdLevel DetectSimdLevel();
+
+// number of puzzles advanced together on the given instruction set
+int LaneWidth(SimdLevel level);
+
+// solves count 9x9 puzzles laid out like SolveBatch, one puzzle per SIMD lane
+// lanes the singles propagation cannot finish drop out to fallback, seeded with the singles found so far,
+// contradictory lanes with the puzzle as it was so fallback classifies invalid and unsolvable puzzles
+void SolveLanes(const std::uint8_t* puzzles, std::uint8_t* solutions, SolveStatus* status, std::size_t count, SudokuSolver& fallback, SimdLevel level);
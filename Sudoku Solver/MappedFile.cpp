@@ -0,0 +1,146 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// empty files have nothing to map but still read as an empty range
+static const char Empty[1] = {};
+
+MappedFile::MappedFile()
+	: View(nullptr), Length(0)
+#ifdef _WIN32
+	, File(INVALID_HANDLE_VALUE), Mapping(nullptr)
+#else
+	, File(-1)
+#endif
+{
+
+}
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::Open(const std::string& path, FileAccess access)
+{
+	Close();
+
+	DWORD flags = (access == FileAccess::Sequential ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_FLAG_RANDOM_ACCESS);
+	File = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, flags, nullptr);
+	if (File == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(File, &size))
+	{
+		Close();
+		return false;
+	}
+
+	Length = (std::size_t)size.QuadPart;
+	if (Length == 0)
+	{
+		View = Empty;
+		return true;
+	}
+
+	Mapping = CreateFileMappingA(File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (Mapping)
+		View = (const char*)MapViewOfFile(Mapping, FILE_MAP_READ, 0, 0, 0);
+
+	if (!View)
+	{
+		Close();
+		return false;
+	}
+
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (View && View != Empty)
+		UnmapViewOfFile(View);
+	if (Mapping)
+		CloseHandle(Mapping);
+	if (File != INVALID_HANDLE_VALUE)
+		CloseHandle(File);
+
+	View = nullptr;
+	Length = 0;
+	Mapping = nullptr;
+	File = INVALID_HANDLE_VALUE;
+}
+
+#else
+
+bool MappedFile::Open(const std::string& path, FileAccess access)
+{
+	Close();
+
+	File = open(path.c_str(), O_RDONLY);
+	if (File < 0)
+		return false;
+
+	struct stat info;
+	if (fstat(File, &info) != 0)
+	{
+		Close();
+		return false;
+	}
+
+	Length = (std::size_t)info.st_size;
+	if (Length == 0)
+	{
+		View = Empty;
+		return true;
+	}
+
+	void* view = mmap(nullptr, Length, PROT_READ, MAP_PRIVATE, File, 0);
+	if (view == MAP_FAILED)
+	{
+		Close();
+		return false;
+	}
+
+	// read-ahead helps files read in order, and only wastes reads on scattered ones
+	madvise(view, Length, access == FileAccess::Sequential ? MADV_SEQUENTIAL : MADV_RANDOM);
+	View = (const char*)view;
+
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (View && View != Empty)
+		munmap((void*)View, Length);
+	if (File >= 0)
+		close(File);
+
+	View = nullptr;
+	Length = 0;
+	File = -1;
+}
+
+#endif
+
+const char* MappedFile::Data() const
+{
+	return View;
+}
+
+std::size_t MappedFile::Size() const
+{
+	return Length;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+// how the pages of a mapped file will be read, a hint for the OS read-ahead
+enum class FileAccess
+{
+	Sequential,		// front to back, once
+	Random			// anywhere, in no particular order
+};
+
+// read-only memory map of a whole file, the pages are loaded by the OS as they are touched
+class MappedFile
+{
+public:
+	// constructor
+	MappedFile();
+
+	// destructor
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	// false if the file cannot be opened or mapped
+	bool Open(const std::string& path, FileAccess access = FileAccess::Sequential);
+	void Close();
+
+	const char* Data() const;
+	std::size_t Size() const;
+
+private:
+	const char* View;
+	std::size_t Length;
+
+#ifdef _WIN32
+	void* File;
+	void* Mapping;
+#else
+	int File;
+#endif
+};
@@ -0,0 +1,390 @@
+#include "ParallelSolver.h"
+#include "SudokuSolver.h"
+#include "BitUtils.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+// how often the calling thread looks at the cancel token of the limits while the workers search
+static const std::chrono::milliseconds CancelPollInterval(1);
+
+template <int BoxHeight, int BoxWidth>
+ParallelSudokuSolver<BoxHeight, BoxWidth>::ParallelSudokuSolver(int threads, int splitDepth)
+{
+	SetThreads(threads);
+	SplitDepth = splitDepth;
+	Exceeded = false;
+	Clear();
+}
+
+template <int BoxHeight, int BoxWidth>
+bool ParallelSudokuSolver<BoxHeight, BoxWidth>::LoadMasks(const std::uint8_t* board, std::uint32_t* row, std::uint32_t* column, std::uint32_t* square)
+{
+	static constexpr BoardGeometry<BoxHeight, BoxWidth> Layout = BoardGeometry<BoxHeight, BoxWidth>();
+
+	std::fill(row, row + Size, 0);
+	std::fill(column, column + Size, 0);
+	std::fill(square, square + Size, 0);
+
+	for (int cell = 0; cell < Cells; cell++)
+	{
+		if (board[cell] == 0)
+			continue;
+
+		if (board[cell] > Size)
+			return false;
+
+		std::uint32_t bit = 1u << (board[cell] - 1);
+		if ((row[Layout.Row[cell]] | column[Layout.Column[cell]] | square[Layout.Square[cell]]) & bit)
+			return false;
+
+		row[Layout.Row[cell]] |= bit;
+		column[Layout.Column[cell]] |= bit;
+		square[Layout.Square[cell]] |= bit;
+	}
+
+	return true;
+}
+
+template <int BoxHeight, int BoxWidth>
+typename ParallelSudokuSolver<BoxHeight, BoxWidth>::SplitResult ParallelSudokuSolver<BoxHeight, BoxWidth>::Split(const Task& task, std::vector<Task>& children)
+{
+	static constexpr BoardGeometry<BoxHeight, BoxWidth> Layout = BoardGeometry<BoxHeight, BoxWidth>();
+	const std::uint32_t AllValues = (1u << Size) - 1;
+
+	// tasks only ever fill candidates, so their boards stay consistent
+	std::uint32_t row[Size], column[Size], square[Size];
+	LoadMasks(task.Board, row, column, square);
+
+	// branch on the empty cell with the fewest candidates, like bkt
+	int best = -1, bestCount = Size + 1;
+	std::uint32_t bestCandidates = 0;
+
+	for (int cell = 0; cell < Cells && bestCount > 1; cell++)
+	{
+		if (task.Board[cell] != 0)
+			continue;
+
+		std::uint32_t candidates = AllValues & ~(row[Layout.Row[cell]] | column[Layout.Column[cell]] | square[Layout.Square[cell]]);
+		int count = PopCount(candidates);
+		if (count == 0)
+			return SplitResult::Dead;
+
+		if (count < bestCount)
+		{
+			best = cell;
+			bestCount = count;
+			bestCandidates = candidates;
+		}
+	}
+
+	if (best == -1)
+		return SplitResult::Solved;
+
+	children.clear();
+	while (bestCandidates)
+	{
+		std::uint32_t bit = bestCandidates & (~bestCandidates + 1);
+		bestCandidates ^= bit;
+
+		children.push_back(task);
+		children.back().Board[best] = (std::uint8_t)(CountTrailingZeros(bit) + 1);
+		children.back().Depth = task.Depth + 1;
+	}
+
+	return SplitResult::Branched;
+}
+
+template <int BoxHeight, int BoxWidth>
+int ParallelSudokuSolver<BoxHeight, BoxWidth>::Run(const std::uint8_t* puzzle, int limit, std::uint8_t* solution)
+{
+	struct WorkQueue
+	{
+		std::mutex Lock;
+		std::deque<Task> Tasks;
+	};
+
+	std::unique_ptr<WorkQueue[]> queues(new WorkQueue[Threads]);
+	std::atomic<int> pending(1);		// tasks queued or running
+	std::atomic<int> queued(1);			// tasks queued
+	std::atomic<int> found(0);
+	std::atomic<bool> cancel(false);		// limit solutions found or the limits ran out
+	std::atomic<bool> exceeded(false);		// the limits ran out
+	std::atomic<std::uint64_t> nodes(0);
+	std::mutex solutionLock;
+	bool haveSolution = false;
+
+	// idle workers sleep until a task is queued or the search is over
+	std::mutex idleLock;
+	std::condition_variable idle;
+
+	auto wake = [&]()
+	{
+		// taking the lock keeps the change from slipping in between a sleeper's check and its wait
+		{ std::lock_guard<std::mutex> guard(idleLock); }
+		idle.notify_all();
+	};
+
+	auto stop = [&](bool outOfBudget)
+	{
+		if (outOfBudget)
+			exceeded = true;
+		cancel = true;
+		wake();
+	};
+
+	Task root;
+	std::copy(puzzle, puzzle + Cells, root.Board);
+	root.Depth = 0;
+	queues[0].Tasks.push_back(root);
+
+	auto worker = [&](int id)
+	{
+		// the search of a subtree stops on the shared token, the limits' own token is watched by the calling thread
+		BasicSudokuSolver<BoxHeight, BoxWidth> solver;
+		SolveLimits limits = Limits;
+		limits.Cancel = &cancel;
+
+		std::vector<Task> children;
+		std::uint8_t leafSolution[Cells];
+		Task task;
+
+		while (!cancel.load(std::memory_order_relaxed))
+		{
+			// newest task of our own queue first, then the oldest task of another queue
+			bool got = false;
+			for (int k = 0; k < Threads && !got; k++)
+			{
+				WorkQueue& queue = queues[(id + k) % Threads];
+				std::lock_guard<std::mutex> guard(queue.Lock);
+
+				if (!queue.Tasks.empty())
+				{
+					if (k == 0)
+					{
+						task = queue.Tasks.back();
+						queue.Tasks.pop_back();
+					}
+					else
+					{
+						task = queue.Tasks.front();
+						queue.Tasks.pop_front();
+					}
+					queued--;
+					got = true;
+				}
+			}
+
+			if (!got)
+			{
+				std::unique_lock<std::mutex> lock(idleLock);
+				idle.wait(lock, [&]() { return queued.load() > 0 || pending.load() == 0 || cancel.load(); });
+
+				if (pending.load() == 0)
+					break;
+				continue;
+			}
+
+			// every task costs one node of the shared budget
+			std::uint64_t used = nodes.fetch_add(1) + 1;
+			if ((Limits.MaxNodes != 0 && used > Limits.MaxNodes) ||
+				(Limits.Deadline != std::chrono::steady_clock::time_point::max() && std::chrono::steady_clock::now() >= Limits.Deadline))
+			{
+				stop(true);
+				break;
+			}
+
+			int solutions = 0;
+			SplitResult result = (task.Depth < SplitDepth ? Split(task, children) : SplitResult::Deep);
+
+			if (result == SplitResult::Branched)
+			{
+				// children are counted before the parent is retired, so pending never drops to 0 early
+				pending += (int)children.size();
+
+				{
+					std::lock_guard<std::mutex> guard(queues[id].Lock);
+					for (int i = (int)children.size() - 1; i >= 0; i--)
+						queues[id].Tasks.push_back(children[i]);
+				}
+
+				queued += (int)children.size();
+				wake();
+			}
+			else if (result == SplitResult::Solved)
+			{
+				solutions = 1;
+				std::copy(task.Board, task.Board + Cells, leafSolution);
+			}
+			else if (result == SplitResult::Deep)
+			{
+				// the subtree gets what is left of the budget (0 would mean no limit)
+				if (Limits.MaxNodes != 0)
+					limits.MaxNodes = std::max<std::uint64_t>(1, Limits.MaxNodes - std::min(nodes.load(), Limits.MaxNodes));
+				solver.SetLimits(limits);
+
+				if (solution)
+					solutions = (solver.Solve(task.Board, leafSolution) == SolveStatus::Solved ? 1 : 0);
+				else
+					solutions = solver.CountSolutions(task.Board, limit - std::min(found.load(), limit - 1));
+
+				nodes += solver.GetNodes();
+
+				// a subtree stopped by the shared token is not out of budget
+				if (solver.BudgetExceeded() && !cancel.load())
+				{
+					stop(true);
+					break;
+				}
+			}
+
+			if (solutions > 0)
+			{
+				if (solution)
+				{
+					std::lock_guard<std::mutex> guard(solutionLock);
+					if (!haveSolution)
+					{
+						std::copy(leafSolution, leafSolution + Cells, solution);
+						haveSolution = true;
+					}
+				}
+
+				// reaching the limit stops every worker, including the ones deep in a subtree
+				if (found.fetch_add(solutions) + solutions >= limit)
+					stop(false);
+			}
+
+			if (--pending == 0)
+				wake();
+		}
+	};
+
+	std::vector<std::thread> workers;
+	for (int i = (Limits.Cancel ? 0 : 1); i < Threads; i++)
+		workers.emplace_back(worker, i);
+
+	if (Limits.Cancel)
+	{
+		// the calling thread forwards the token of the limits to the workers
+		std::unique_lock<std::mutex> lock(idleLock);
+		while (!idle.wait_for(lock, CancelPollInterval, [&]() { return pending.load() == 0 || cancel.load(); }))
+		{
+			if (Limits.Cancel->load(std::memory_order_relaxed))
+			{
+				exceeded = true;
+				cancel = true;
+				idle.notify_all();
+			}
+		}
+	}
+	else
+		worker(0);
+
+	for (std::thread& thread : workers)
+		thread.join();
+
+	// solutions found up to the limit count as a finished search
+	Exceeded = (exceeded.load() && found.load() < limit);
+	return std::min(found.load(), limit);
+}
+
+template <int BoxHeight, int BoxWidth>
+SolveStatus ParallelSudokuSolver<BoxHeight, BoxWidth>::Solve(const std::uint8_t* puzzle, std::uint8_t* solution)
+{
+	std::uint32_t row[Size], column[Size], square[Size];
+	Exceeded = false;
+	if (!LoadMasks(puzzle, row, column, square))
+	{
+		std::copy(puzzle, puzzle + Cells, solution);
+		return SolveStatus::Invalid;
+	}
+
+	std::uint8_t found[Cells];
+	if (Run(puzzle, 1, found) == 0)
+	{
+		std::copy(puzzle, puzzle + Cells, solution);
+		return (Exceeded ? SolveStatus::BudgetExceeded : SolveStatus::Unsolvable);
+	}
+
+	std::copy(found, found + Cells, solution);
+	return SolveStatus::Solved;
+}
+
+template <int BoxHeight, int BoxWidth>
+bool ParallelSudokuSolver<BoxHeight, BoxWidth>::Solve()
+{
+	return Solve(Board, Board) == SolveStatus::Solved;
+}
+
+template <int BoxHeight, int BoxWidth>
+int ParallelSudokuSolver<BoxHeight, BoxWidth>::CountSolutions(const std::uint8_t* puzzle, int limit)
+{
+	std::uint32_t row[Size], column[Size], square[Size];
+	Exceeded = false;
+	if (!LoadMasks(puzzle, row, column, square))
+		return 0;
+
+	return Run(puzzle, limit, nullptr);
+}
+
+template <int BoxHeight, int BoxWidth>
+int ParallelSudokuSolver<BoxHeight, BoxWidth>::CountSolutions(int limit)
+{
+	return CountSolutions(Board, limit);
+}
+
+template <int BoxHeight, int BoxWidth>
+void ParallelSudokuSolver<BoxHeight, BoxWidth>::SetThreads(int threads)
+{
+	Threads = (threads > 0 ? threads : std::max(1, (int)std::thread::hardware_concurrency()));
+}
+
+template <int BoxHeight, int BoxWidth>
+void ParallelSudokuSolver<BoxHeight, BoxWidth>::SetSplitDepth(int splitDepth)
+{
+	SplitDepth = splitDepth;
+}
+
+template <int BoxHeight, int BoxWidth>
+void ParallelSudokuSolver<BoxHeight, BoxWidth>::SetLimits(const SolveLimits& limits)
+{
+	Limits = limits;
+}
+
+template <int BoxHeight, int BoxWidth>
+bool ParallelSudokuSolver<BoxHeight, BoxWidth>::BudgetExceeded()
+{
+	return Exceeded;
+}
+
+template <int BoxHeight, int BoxWidth>
+void ParallelSudokuSolver<BoxHeight, BoxWidth>::SetTableValue(int row, int column, int value)
+{
+	Board[(row - 1) * Size + column - 1] = (std::uint8_t)value;
+}
+
+template <int BoxHeight, int BoxWidth>
+int ParallelSudokuSolver<BoxHeight, BoxWidth>::GetTableValue(int row, int column)
+{
+	return Board[(row - 1) * Size + column - 1];
+}
+
+template <int BoxHeight, int BoxWidth>
+void ParallelSudokuSolver<BoxHeight, BoxWidth>::Clear()
+{
+	std::fill(Board, Board + Cells, 0);
+}
+
+// board geometries compiled into the solver
+template class ParallelSudokuSolver<3, 3>;
+template class ParallelSudokuSolver<4, 4>;
+template class ParallelSudokuSolver<5, 5>;
+template class ParallelSudokuSolver<2, 3>;
+template class ParallelSudokuSolver<3, 4>;
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "SudokuEngine.h"
+
+// solver for a single hard puzzle that keeps every core busy
+// the search tree is split into tasks at shallow depths, each worker runs its tasks depth first
+// and steals the oldest (largest) tasks of the others once its own queue is empty, or sleeps until there is one
+// instantiated in ParallelSolver.cpp for the same geometries as BasicSudokuSolver
+template <int BoxHeight, int BoxWidth>
+class ParallelSudokuSolver : public SudokuEngine
+{
+public:
+	static const int Size = BoxHeight * BoxWidth;
+	static const int Cells = Size * Size;
+
+	// constructor : 0 threads uses one per hardware thread
+	// tasks are split further while fewer than splitDepth cells were guessed
+	ParallelSudokuSolver(int threads = 0, int splitDepth = 6);
+
+	bool Solve() override;
+	SolveStatus Solve(const std::uint8_t* puzzle, std::uint8_t* solution);
+
+	int CountSolutions(int limit) override;
+	int CountSolutions(const std::uint8_t* puzzle, int limit);
+
+	void SetThreads(int threads);
+	void SetSplitDepth(int splitDepth);
+
+	// bounds every following Solve / CountSolutions : the workers of one call share MaxNodes (every task
+	// costs one node, a subtree what its search took), the deadline and the cancel token stop all of them
+	void SetLimits(const SolveLimits& limits);
+
+	// true if the last search was stopped by the limits (CountSolutions then returns a lower bound)
+	bool BudgetExceeded();
+
+	void SetTableValue(int row, int column, int value) override;
+	int GetTableValue(int row, int column) override;
+
+	void Clear() override;
+
+private:
+	int Threads, SplitDepth;
+	std::uint8_t Board[Cells];
+	SolveLimits Limits;
+	bool Exceeded;
+
+	struct Task
+	{
+		std::uint8_t Board[Cells];
+		int Depth;		// cells guessed since the puzzle
+	};
+
+	// what Split did with a task
+	enum class SplitResult
+	{
+		Dead,		// some empty cell has no candidate left
+		Solved,		// no empty cell left
+		Branched,	// one child task for every candidate of the most constrained cell
+		Deep		// not split, the whole subtree is searched by one worker
+	};
+
+	// used values of every row / column / square, false if two givens clash or a value is out of range
+	static bool LoadMasks(const std::uint8_t* board, std::uint32_t* row, std::uint32_t* column, std::uint32_t* square);
+
+	SplitResult Split(const Task& task, std::vector<Task>& children);
+
+	// runs the worker pool until limit solutions are found or the tree is exhausted
+	// the first solution found is written to solution if it is not nullptr
+	int Run(const std::uint8_t* puzzle, int limit, std::uint8_t* solution);
+};
@@ -0,0 +1,498 @@
+#include "PuzzlePack.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+#include "BatchSolver.h"
+#include "SudokuSolver.h"
+
+std::uint64_t PackChecksum(const std::uint8_t* data, std::size_t size)
+{
+	const std::uint64_t Prime = 1099511628211ull;
+	std::uint64_t hash = 14695981039346656037ull;
+
+	std::size_t i = 0;
+	for (; i + 8 <= size; i += 8)
+	{
+		std::uint64_t word;
+		std::memcpy(&word, data + i, 8);
+		hash = (hash ^ word) * Prime;
+	}
+	for (; i < size; i++)
+		hash = (hash ^ data[i]) * Prime;
+
+	return hash;
+}
+
+void PackGrid(const std::uint8_t* grid, int cells, std::uint8_t* bytes)
+{
+	int i = 0;
+	for (; i + 1 < cells; i += 2)
+		*bytes++ = (std::uint8_t)((grid[i] & 15) | (grid[i + 1] << 4));
+	if (i < cells)
+		*bytes = (std::uint8_t)(grid[i] & 15);
+}
+
+void UnpackGrid(const std::uint8_t* bytes, int cells, std::uint8_t* grid)
+{
+	int i = 0;
+	for (; i + 1 < cells; i += 2, bytes++)
+	{
+		grid[i] = *bytes & 15;
+		grid[i + 1] = *bytes >> 4;
+	}
+	if (i < cells)
+		grid[i] = *bytes & 15;
+}
+
+// ---------------------------------------- reader ----------------------------------------
+
+PuzzlePack::PuzzlePack()
+	: Header(nullptr), Index(nullptr), Cells(0), GridBytes(0)
+{
+
+}
+
+bool PuzzlePack::Open(const std::string& path, FileAccess access)
+{
+	Close();
+
+	if (!File.Open(path, access))
+		return false;
+
+	const std::uint8_t* data = (const std::uint8_t*)File.Data();
+	std::size_t size = File.Size();
+	const PackHeader* header = (const PackHeader*)data;
+
+	if (size < sizeof(PackHeader) || std::memcmp(header->Magic, PackMagic, sizeof(PackMagic)) != 0 || header->Version != PackVersion)
+	{
+		Close();
+		return false;
+	}
+
+	int values = header->BoxHeight * header->BoxWidth;
+	std::uint64_t indexSize = (std::uint64_t)header->BlockCount * sizeof(PackBlock);
+
+	if (values == 0 || values > 15 || header->BlockSize == 0 || header->IndexOffset % 8 != 0 || header->IndexOffset > size || indexSize > size - header->IndexOffset ||
+		PackChecksum(data + header->IndexOffset, (std::size_t)indexSize) != header->IndexChecksum)
+	{
+		Close();
+		return false;
+	}
+
+	Header = header;
+	Index = (const PackBlock*)(data + header->IndexOffset);
+	Cells = values * values;
+	GridBytes = (Cells + 1) / 2;
+
+	// every block has to lie inside the file before grids are read without checks
+	std::uint64_t count = 0;
+	for (std::uint32_t i = 0; i < header->BlockCount; i++)
+	{
+		std::uint64_t blockSize = BlockBytes(Index[i].Count);
+		bool full = (i + 1 == header->BlockCount || Index[i].Count == header->BlockSize);
+
+		if (!full || Index[i].Count > header->BlockSize || Index[i].Offset > size || blockSize > size - Index[i].Offset)
+		{
+			Close();
+			return false;
+		}
+		count += Index[i].Count;
+	}
+
+	if (count != header->Count)
+	{
+		Close();
+		return false;
+	}
+
+	return true;
+}
+
+void PuzzlePack::Close()
+{
+	File.Close();
+	Header = nullptr;
+	Index = nullptr;
+	Cells = GridBytes = 0;
+}
+
+int PuzzlePack::GetBoxHeight() const
+{
+	return (Header ? Header->BoxHeight : 0);
+}
+
+int PuzzlePack::GetBoxWidth() const
+{
+	return (Header ? Header->BoxWidth : 0);
+}
+
+std::uint64_t PuzzlePack::GetCount() const
+{
+	return (Header ? Header->Count : 0);
+}
+
+bool PuzzlePack::HasSolutions() const
+{
+	return (Header && (Header->Flags & PackHasSolutions));
+}
+
+void PuzzlePack::ReadPuzzles(std::uint64_t first, std::size_t count, std::uint8_t* puzzles) const
+{
+	Read(first, count, false, puzzles);
+}
+
+void PuzzlePack::ReadSolutions(std::uint64_t first, std::size_t count, std::uint8_t* solutions) const
+{
+	if (HasSolutions())
+		Read(first, count, true, solutions);
+}
+
+void PuzzlePack::ReadSolutionStatus(std::uint64_t first, std::size_t count, PackSolution* status) const
+{
+	if (!HasSolutions() || first >= Header->Count)
+		return;
+	count = (std::size_t)std::min<std::uint64_t>(count, Header->Count - first);
+
+	const std::uint8_t* data = (const std::uint8_t*)File.Data();
+	std::uint32_t block = (std::uint32_t)(first / Header->BlockSize);
+	std::uint32_t position = (std::uint32_t)(first % Header->BlockSize);
+
+	while (count > 0)
+	{
+		const PackBlock& entry = Index[block];
+		const std::uint8_t* bytes = data + entry.Offset + (std::uint64_t)entry.Count * GridBytes * 2 + position;
+		std::size_t n = std::min<std::size_t>(count, entry.Count - position);
+
+		// damaged bytes read as unchecked rather than as a value outside the enum
+		for (std::size_t i = 0; i < n; i++)
+			*status++ = (bytes[i] <= (std::uint8_t)PackSolution::Unsolvable ? (PackSolution)bytes[i] : PackSolution::Unchecked);
+
+		count -= n;
+		block++;
+		position = 0;
+	}
+}
+
+void PuzzlePack::Read(std::uint64_t first, std::size_t count, bool solutions, std::uint8_t* grids) const
+{
+	if (!Header || first >= Header->Count)
+		return;
+	count = (std::size_t)std::min<std::uint64_t>(count, Header->Count - first);
+
+	const std::uint8_t* data = (const std::uint8_t*)File.Data();
+
+	// every block but the last one is full, so puzzle #k is in block k / BlockSize
+	std::uint32_t block = (std::uint32_t)(first / Header->BlockSize);
+	std::uint32_t position = (std::uint32_t)(first % Header->BlockSize);
+
+	while (count > 0)
+	{
+		const PackBlock& entry = Index[block];
+		const std::uint8_t* bytes = data + entry.Offset + ((solutions ? entry.Count : 0) + (std::uint64_t)position) * GridBytes;
+		std::size_t n = std::min<std::size_t>(count, entry.Count - position);
+
+		for (std::size_t i = 0; i < n; i++, bytes += GridBytes, grids += Cells)
+			UnpackGrid(bytes, Cells, grids);
+
+		count -= n;
+		block++;
+		position = 0;
+	}
+}
+
+bool PuzzlePack::Verify() const
+{
+	if (!Header)
+		return false;
+
+	const std::uint8_t* data = (const std::uint8_t*)File.Data();
+	for (std::uint32_t i = 0; i < Header->BlockCount; i++)
+	{
+		std::size_t size = (std::size_t)BlockBytes(Index[i].Count);
+		if (PackChecksum(data + Index[i].Offset, size) != Index[i].Checksum)
+			return false;
+	}
+
+	return true;
+}
+
+std::uint64_t PuzzlePack::BlockBytes(std::uint64_t count) const
+{
+	// puzzles, or puzzles, solutions and status bytes
+	return (HasSolutions() ? count * (GridBytes * 2 + 1) : count * GridBytes);
+}
+
+// ---------------------------------------- writer ----------------------------------------
+
+PuzzlePackWriter::PuzzlePackWriter()
+	: Header(), Pending(0), WithSolutions(false), Cells(0), GridBytes(0)
+{
+
+}
+
+PuzzlePackWriter::~PuzzlePackWriter()
+{
+	Close();
+}
+
+bool PuzzlePackWriter::Open(const std::string& path, int boxHeight, int boxWidth, bool withSolutions, int blockSize)
+{
+	Close();
+
+	int values = boxHeight * boxWidth;
+	if (boxHeight <= 0 || boxWidth <= 0 || values > 15 || blockSize <= 0)
+		return false;
+
+	File.open(path, std::ios::binary | std::ios::trunc);
+	if (!File)
+		return false;
+
+	Header = PackHeader();
+	std::memcpy(Header.Magic, PackMagic, sizeof(PackMagic));
+	Header.Version = PackVersion;
+	Header.BoxHeight = (std::uint8_t)boxHeight;
+	Header.BoxWidth = (std::uint8_t)boxWidth;
+	Header.Flags = (withSolutions ? PackHasSolutions : 0);
+	Header.BlockSize = (std::uint32_t)blockSize;
+
+	Cells = values * values;
+	GridBytes = (Cells + 1) / 2;
+	WithSolutions = withSolutions;
+	Block.assign((std::size_t)blockSize * (withSolutions ? GridBytes * 2 + 1 : GridBytes), 0);
+	Index.clear();
+	Pending = 0;
+
+	// the header is written again with the counts once the file is complete
+	File.write((const char*)&Header, sizeof(Header));
+	return (bool)File;
+}
+
+void PuzzlePackWriter::Add(const std::uint8_t* puzzle, const std::uint8_t* solution, PackSolution status)
+{
+	if (!File.is_open())
+		return;
+
+	PackGrid(puzzle, Cells, &Block[(std::size_t)Pending * GridBytes]);
+	if (WithSolutions)
+	{
+		std::uint8_t* bytes = &Block[((std::size_t)Header.BlockSize + Pending) * GridBytes];
+		if (solution)
+			PackGrid(solution, Cells, bytes);
+		else
+			std::memset(bytes, 0, GridBytes);
+
+		Block[(std::size_t)Header.BlockSize * GridBytes * 2 + Pending] = (std::uint8_t)status;
+	}
+
+	Header.Count++;
+	if (++Pending == Header.BlockSize)
+		FlushBlock();
+}
+
+void PuzzlePackWriter::FlushBlock()
+{
+	if (Pending == 0)
+		return;
+
+	std::size_t size = (std::size_t)Pending * GridBytes;
+
+	// a short last block moves its solutions and status bytes right after its puzzles
+	if (WithSolutions)
+	{
+		if (Pending < Header.BlockSize)
+		{
+			std::memmove(&Block[size], &Block[(std::size_t)Header.BlockSize * GridBytes], size);
+			std::memmove(&Block[size * 2], &Block[(std::size_t)Header.BlockSize * GridBytes * 2], Pending);
+		}
+		size = size * 2 + Pending;
+	}
+
+	PackBlock block = {};
+	block.Offset = (std::uint64_t)File.tellp();
+	block.Count = Pending;
+	block.Checksum = PackChecksum(Block.data(), size);
+	Index.push_back(block);
+
+	File.write((const char*)Block.data(), size);
+	Pending = 0;
+}
+
+bool PuzzlePackWriter::Close()
+{
+	if (!File.is_open())
+		return false;
+
+	FlushBlock();
+
+	// the index is read in place, so it starts on an 8 byte boundary
+	static const char Padding[8] = {};
+	std::uint64_t offset = (std::uint64_t)File.tellp();
+	File.write(Padding, (std::streamsize)((8 - offset % 8) % 8));
+
+	Header.BlockCount = (std::uint32_t)Index.size();
+	Header.IndexOffset = (std::uint64_t)File.tellp();
+	Header.IndexChecksum = PackChecksum((const std::uint8_t*)Index.data(), Index.size() * sizeof(PackBlock));
+
+	File.write((const char*)Index.data(), Index.size() * sizeof(PackBlock));
+	File.seekp(0);
+	File.write((const char*)&Header, sizeof(Header));
+
+	bool success = (bool)File;
+	File.close();
+
+	Index.clear();
+	Block.clear();
+
+	return success;
+}
+
+// ---------------------------------------- converters ----------------------------------------
+
+// solves count 9x9 puzzles and tells unique solutions from the first one of several
+static void SolvePack(const std::uint8_t* puzzles, std::uint8_t* solutions, PackSolution* kinds, std::size_t count)
+{
+	const int Cells = 81;
+
+	std::vector<SolveStatus> status(count);
+	SolveBatch<3, 3>(puzzles, solutions, status.data(), count);
+
+	// a second search stops at the second solution, shared by as many workers as the solves
+	std::atomic<std::size_t> next(0);
+	auto worker = [&]()
+	{
+		BasicSudokuSolver<3, 3> solver;
+
+		for (std::size_t i = next++; i < count; i = next++)
+		{
+			if (status[i] == SolveStatus::Solved)
+				kinds[i] = (solver.CountSolutions(puzzles + i * Cells, 2) == 1 ? PackSolution::Unique : PackSolution::Multiple);
+			else
+				kinds[i] = (status[i] == SolveStatus::Invalid ? PackSolution::Invalid : PackSolution::Unsolvable);
+		}
+	};
+
+	std::vector<std::thread> workers;
+	for (unsigned i = 1; i < std::thread::hardware_concurrency(); i++)
+		workers.emplace_back(worker);
+
+	worker();
+
+	for (std::thread& thread : workers)
+		thread.join();
+}
+
+bool ParsePuzzleLine(const char* line, const char* lineEnd, std::uint8_t* puzzle)
+{
+	const int Cells = 81;
+	bool valid = (lineEnd - line >= Cells);
+
+	for (int i = 0; i < Cells; i++)
+	{
+		char c = (line + i < lineEnd ? line[i] : '.');
+
+		if (c >= '1' && c <= '9')
+			puzzle[i] = (std::uint8_t)(c - '0');
+		else
+		{
+			puzzle[i] = 0;
+			valid &= (c == '.' || c == '0');
+		}
+	}
+
+	return valid;
+}
+
+long long TextToPack(const std::string& textPath, const std::string& packPath, bool withSolutions, long long* malformedLine)
+{
+	const int Cells = 81;
+	const std::size_t BatchSize = 4096;
+
+	MappedFile file;
+	PuzzlePackWriter writer;
+	if (!file.Open(textPath) || !writer.Open(packPath, 3, 3, withSolutions))
+		return -1;
+
+	std::vector<std::uint8_t> puzzles(BatchSize * Cells), solutions(withSolutions ? BatchSize * Cells : 0);
+	std::vector<PackSolution> status(withSolutions ? BatchSize : 0);
+
+	const char* text = file.Data();
+	const char* end = text + file.Size();
+	long long count = 0;
+
+	while (text < end)
+	{
+		std::size_t batch = 0;
+		for (; text < end && batch < BatchSize; batch++)
+		{
+			const char* newline = (const char*)std::memchr(text, '\n', end - text);
+			const char* lineEnd = (newline ? newline : end);
+
+			// a guessed puzzle would be solved as if it was the real one
+			if (!ParsePuzzleLine(text, lineEnd, &puzzles[batch * Cells]))
+			{
+				if (malformedLine)
+					*malformedLine = count + (long long)batch + 1;
+
+				writer.Close();
+				std::remove(packPath.c_str());
+				return -1;
+			}
+
+			text = (newline ? newline + 1 : end);
+		}
+
+		// unsolved puzzles keep their givens as the solution, their status tells them apart
+		if (withSolutions)
+			SolvePack(puzzles.data(), solutions.data(), status.data(), batch);
+
+		for (std::size_t i = 0; i < batch; i++)
+		{
+			if (withSolutions)
+				writer.Add(&puzzles[i * Cells], &solutions[i * Cells], status[i]);
+			else
+				writer.Add(&puzzles[i * Cells]);
+		}
+		count += batch;
+	}
+
+	return (writer.Close() ? count : -1);
+}
+
+long long PackToText(const std::string& packPath, const std::string& textPath)
+{
+	const int Cells = 81;
+	const std::size_t BatchSize = 4096;
+
+	PuzzlePack pack;
+	if (!pack.Open(packPath, FileAccess::Sequential) || pack.GetBoxHeight() != 3 || pack.GetBoxWidth() != 3)
+		return -1;
+
+	std::ofstream file(textPath, std::ios::binary | std::ios::trunc);
+	if (!file)
+		return -1;
+
+	std::vector<std::uint8_t> puzzles(BatchSize * Cells);
+	std::vector<char> text(BatchSize * (Cells + 1));
+
+	for (std::uint64_t first = 0; first < pack.GetCount(); first += BatchSize)
+	{
+		std::size_t batch = (std::size_t)std::min<std::uint64_t>(BatchSize, pack.GetCount() - first);
+		pack.ReadPuzzles(first, batch, puzzles.data());
+
+		char* line = text.data();
+		for (std::size_t i = 0; i < batch * Cells; i++)
+		{
+			*line++ = (puzzles[i] ? (char)('0' + puzzles[i]) : '.');
+			if (i % Cells == Cells - 1)
+				*line++ = '\n';
+		}
+
+		file.write(text.data(), line - text.data());
+	}
+
+	return (file ? (long long)pack.GetCount() : -1);
+}
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "MappedFile.h"
+
+// binary puzzle file, little-endian :
+//   PackHeader
+//   blocks of up to BlockSize grids : the puzzles, then if the file has solutions
+//   their solutions and one PackSolution byte per puzzle
+//   PackBlock index, one entry per block
+// grids are packed 4 bits per cell, row by row, the first cell in the low bits (41 bytes for 9x9)
+// so boards up to 15 values (6x6, 9x9, 12x12) fit
+
+const char PackMagic[8] = { 'S', 'U', 'D', 'O', 'K', 'U', 'P', 'K' };
+const std::uint32_t PackVersion = 2;
+const std::uint8_t PackHasSolutions = 1;		// PackHeader::Flags
+
+// what the stored solution of a puzzle is worth
+enum class PackSolution : std::uint8_t
+{
+	Unchecked,		// stored as given to the writer
+	Unique,			// the only solution
+	Multiple,		// one of several solutions
+	Invalid,		// two given values share a row / column / square, the solution holds the givens
+	Unsolvable		// no solution, the solution holds the givens
+};
+
+struct PackHeader
+{
+	char Magic[8];
+	std::uint32_t Version;
+	std::uint8_t BoxHeight, BoxWidth;
+	std::uint8_t Flags;
+	std::uint8_t Reserved;
+	std::uint64_t Count;				// puzzles in the file
+	std::uint32_t BlockSize;			// puzzles per block, the last block may have fewer
+	std::uint32_t BlockCount;
+	std::uint64_t IndexOffset;			// file offset of the block index
+	std::uint64_t IndexChecksum;		// PackChecksum of the block index
+	std::uint64_t Unused[2];
+};
+
+struct PackBlock
+{
+	std::uint64_t Offset;				// file offset of the first puzzle
+	std::uint32_t Count;
+	std::uint32_t Reserved;
+	std::uint64_t Checksum;				// PackChecksum of the block, solutions and their status included
+};
+
+static_assert(sizeof(PackHeader) == 64, "PackHeader is part of the file format");
+static_assert(sizeof(PackBlock) == 24, "PackBlock is part of the file format");
+
+// FNV-1a over 8 byte words
+std::uint64_t PackChecksum(const std::uint8_t* data, std::size_t size);
+
+// one byte per cell <-> 4 bits per cell, bytes is (cells + 1) / 2 long
+void PackGrid(const std::uint8_t* grid, int cells, std::uint8_t* bytes);
+void UnpackGrid(const std::uint8_t* bytes, int cells, std::uint8_t* grid);
+
+// memory mapped reader, any puzzle can be read without touching the ones before it
+class PuzzlePack
+{
+public:
+	// constructor
+	PuzzlePack();
+
+	// false if the file is missing, not a puzzle pack, or its index is damaged
+	// readers that go through the whole pack in order pass FileAccess::Sequential
+	bool Open(const std::string& path, FileAccess access = FileAccess::Random);
+	void Close();
+
+	int GetBoxHeight() const;
+	int GetBoxWidth() const;
+	std::uint64_t GetCount() const;
+	bool HasSolutions() const;
+
+	// unpack puzzles / solutions [first, first + count) back to back, one byte per cell
+	void ReadPuzzles(std::uint64_t first, std::size_t count, std::uint8_t* puzzles) const;
+	void ReadSolutions(std::uint64_t first, std::size_t count, std::uint8_t* solutions) const;
+	void ReadSolutionStatus(std::uint64_t first, std::size_t count, PackSolution* status) const;
+
+	// checks the data of every block against its checksum
+	bool Verify() const;
+
+private:
+	MappedFile File;
+	const PackHeader* Header;
+	const PackBlock* Index;
+	int Cells, GridBytes;
+
+	void Read(std::uint64_t first, std::size_t count, bool solutions, std::uint8_t* grids) const;
+	std::uint64_t BlockBytes(std::uint64_t count) const;
+};
+
+// writes a puzzle pack one puzzle at a time, only one block is kept in memory
+class PuzzlePackWriter
+{
+public:
+	// constructor
+	PuzzlePackWriter();
+
+	// destructor : closes the file
+	~PuzzlePackWriter();
+
+	bool Open(const std::string& path, int boxHeight, int boxWidth, bool withSolutions, int blockSize = 4096);
+
+	// solution and status are ignored for files without solutions
+	void Add(const std::uint8_t* puzzle, const std::uint8_t* solution = nullptr, PackSolution status = PackSolution::Unchecked);
+
+	// writes the last block, the index and the header, false if some write failed
+	bool Close();
+
+private:
+	std::ofstream File;
+	PackHeader Header;
+	std::vector<PackBlock> Index;
+	std::vector<std::uint8_t> Block;		// packed puzzles of the current block, then room for as many solutions and status bytes
+	std::uint32_t Pending;
+	bool WithSolutions;
+	int Cells, GridBytes;
+
+	void FlushBlock();
+};
+
+// 9x9 text files : one puzzle per line, 81 characters with '.' or '0' for empty cells, anything after them is ignored
+// reads the line [line, lineEnd) into puzzle, false if it is shorter or has other characters than digits and '.'
+// (the cells are still filled, unreadable ones as empty)
+bool ParsePuzzleLine(const char* line, const char* lineEnd, std::uint8_t* puzzle);
+
+// converters between text files and puzzle packs, solved packs store the solution of every puzzle too
+// and whether it is unique
+// both return the number of puzzles converted, or -1 if a file cannot be opened
+// TextToPack also fails on the first malformed line, which it reports in malformedLine (counted from 1),
+// and removes the incomplete pack
+long long TextToPack(const std::string& textPath, const std::string& packPath, bool withSolutions = false, long long* malformedLine = nullptr);
+long long PackToText(const std::string& packPath, const std::string& textPath);
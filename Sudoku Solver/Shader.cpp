@@ -89,6 +89,16 @@ void Shader::SetMatrix4f(const char* name, const glm::mat4& value)
 	glUniformMatrix4fv(glGetUniformLocation(ID, name), 1, false, glm::value_ptr(value));
 }
 
+void Shader::SetVector3fv(const char* name, const glm::vec3* values, int count)
+{
+	glUniform3fv(glGetUniformLocation(ID, name), count, glm::value_ptr(values[0]));
+}
+
+void Shader::SetVector4fv(const char* name, const glm::vec4* values, int count)
+{
+	glUniform4fv(glGetUniformLocation(ID, name), count, glm::value_ptr(values[0]));
+}
+
 void Shader::CheckCompileErrors(GLuint object, std::string type)
 {
 	int success;
@@ -30,6 +30,10 @@ public:
 	void SetVector4f(const char* name, const glm::vec4& value);
 	void SetMatrix4f(const char* name, const glm::mat4& value);
 
+	// uniform arrays
+	void SetVector3fv(const char* name, const glm::vec3* values, int count);
+	void SetVector4fv(const char* name, const glm::vec4* values, int count);
+
 private:
 	void CheckCompileErrors(GLuint object, std::string type);
 };
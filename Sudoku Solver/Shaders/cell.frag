@@ -0,0 +1,14 @@
+#version 330 core
+
+out vec4 FragColor;
+
+in vec2 TexCoords;
+in vec3 CellColor;
+
+uniform sampler2D text;
+
+void main()
+{
+	vec4 sampled = vec4(1.0, 1.0, 1.0, texture(text, TexCoords).r);
+	FragColor = vec4(CellColor, 1.0) * sampled;
+}
@@ -0,0 +1,27 @@
+#version 330 core
+
+layout (location = 0) in vec2 aPos;			// corner of the unit quad
+layout (location = 1) in vec4 instance;		// <vec2 column / row, value, state>
+
+out vec2 TexCoords;
+out vec3 CellColor;
+
+uniform mat4 projection;
+uniform vec2 origin;
+uniform float squareSize;
+
+uniform vec4 glyphRects[26];		// <vec2 offset, vec2 size> inside the cell in pixels, empty for value 0
+uniform vec4 glyphUVs[26];			// <vec2 top left, vec2 bottom right> in the atlas
+uniform vec3 stateColors[2];
+
+void main()
+{
+	int value = int(instance.z);
+	vec4 rect = glyphRects[value];
+
+	vec2 position = origin + instance.xy * squareSize + rect.xy + aPos * rect.zw;
+	gl_Position = projection * vec4(position, 0.0, 1.0);
+
+	TexCoords = mix(glyphUVs[value].xy, glyphUVs[value].zw, aPos);
+	CellColor = stateColors[int(instance.w)];
+}
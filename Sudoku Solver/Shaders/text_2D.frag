@@ -3,12 +3,12 @@
 out vec4 FragColor;
 
 in vec2 TexCoords;
+in vec3 TextColor;
 
 uniform sampler2D text;
-uniform vec3 textColor;
 
 void main()
 {
 	vec4 sampled = vec4(1.0, 1.0, 1.0, texture(text, TexCoords).r);
-	FragColor = vec4(textColor, 1.0) * sampled;
+	FragColor = vec4(TextColor, 1.0) * sampled;
 }
@@ -0,0 +1,153 @@
+#include "SolutionCache.h"
+#include "PuzzlePack.h"
+
+SolutionCache::SolutionCache(std::size_t capacity)
+	: Capacity(capacity), Hits(0), Misses(0)
+{
+
+}
+
+SolveStatus SolutionCache::Solve(const std::uint8_t* puzzle, std::uint8_t* solution, SudokuSolver& solver)
+{
+	std::uint8_t canonical[81];
+	SudokuTransform transform;
+
+	// invalid puzzles are never cached, the solver reports them
+	if (!Canonicalize(puzzle, canonical, transform))
+		return solver.Solve(puzzle, solution);
+
+	if (Find(canonical, transform, solution))
+		return SolveStatus::Solved;
+
+	SolveStatus status = solver.Solve(puzzle, solution);
+	if (status == SolveStatus::Solved)
+		Store(canonical, transform, solution);
+
+	return status;
+}
+
+bool SolutionCache::Lookup(const std::uint8_t* puzzle, std::uint8_t* solution)
+{
+	std::uint8_t canonical[81];
+	SudokuTransform transform;
+
+	return Canonicalize(puzzle, canonical, transform) && Find(canonical, transform, solution);
+}
+
+void SolutionCache::Insert(const std::uint8_t* puzzle, const std::uint8_t* solution)
+{
+	std::uint8_t canonical[81];
+	SudokuTransform transform;
+
+	if (Canonicalize(puzzle, canonical, transform))
+		Store(canonical, transform, solution);
+}
+
+std::uint64_t SolutionCache::GetHits()
+{
+	std::lock_guard<std::mutex> guard(Lock);
+	return Hits;
+}
+
+std::uint64_t SolutionCache::GetMisses()
+{
+	std::lock_guard<std::mutex> guard(Lock);
+	return Misses;
+}
+
+std::size_t SolutionCache::GetSize()
+{
+	std::lock_guard<std::mutex> guard(Lock);
+	return Entries.size();
+}
+
+void SolutionCache::Clear()
+{
+	std::lock_guard<std::mutex> guard(Lock);
+	Recent.clear();
+	Entries.clear();
+	Hits = Misses = 0;
+}
+
+SolutionCache::Key SolutionCache::Hash(const std::uint8_t* canonical)
+{
+	std::uint8_t bytes[41];
+	PackGrid(canonical, 81, bytes);
+
+	// two FNV-1a style hashes with different primes and offsets
+	Key key = { 14695981039346656037ull, 0x9E3779B97F4A7C15ull };
+	for (int i = 0; i < 41; i++)
+	{
+		key.Low = (key.Low ^ bytes[i]) * 1099511628211ull;
+		key.High = (key.High ^ bytes[i]) * 0xFF51AFD7ED558CCDull;
+		key.High ^= key.High >> 29;
+	}
+
+	return key;
+}
+
+bool SolutionCache::Find(const std::uint8_t* canonical, const SudokuTransform& transform, std::uint8_t* solution)
+{
+	Key key = Hash(canonical);
+	std::uint8_t grid[81];
+
+	{
+		std::lock_guard<std::mutex> guard(Lock);
+
+		auto entry = Entries.find(key);
+		if (entry == Entries.end())
+		{
+			Misses++;
+			return false;
+		}
+
+		// a hash collision would show as a solution that does not keep the givens
+		UnpackGrid(entry->second->Solution, 81, grid);
+		for (int i = 0; i < 81; i++)
+			if (canonical[i] && canonical[i] != grid[i])
+			{
+				Misses++;
+				return false;
+			}
+
+		Recent.splice(Recent.begin(), Recent, entry->second);
+		Hits++;
+	}
+
+	InvertTransform(transform, grid, solution);
+	return true;
+}
+
+void SolutionCache::Store(const std::uint8_t* canonical, const SudokuTransform& transform, const std::uint8_t* solution)
+{
+	if (Capacity == 0)
+		return;
+
+	Key key = Hash(canonical);
+
+	Entry entry;
+	entry.Puzzle = key;
+
+	std::uint8_t grid[81];
+	ApplyTransform(transform, solution, grid);
+	PackGrid(grid, 81, entry.Solution);
+
+	std::lock_guard<std::mutex> guard(Lock);
+
+	// another thread may have solved the same puzzle meanwhile
+	auto existing = Entries.find(key);
+	if (existing != Entries.end())
+	{
+		Recent.splice(Recent.begin(), Recent, existing->second);
+		return;
+	}
+
+	Recent.push_front(entry);
+	Entries[key] = Recent.begin();
+
+	if (Entries.size() > Capacity)
+	{
+		Entries.erase(Recent.back().Puzzle);
+		Recent.pop_back();
+	}
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+#include "CanonicalForm.h"
+#include "SudokuSolver.h"
+
+// bounded LRU cache of 9x9 solutions, shared by any number of threads
+// puzzles are keyed by a 128-bit hash of their canonical form, so every relabeled, reflected or
+// reordered copy of a solved puzzle is a hit
+// every lookup canonicalizes the puzzle (tens of microseconds), so it pays off for puzzles that take longer to solve
+class SolutionCache
+{
+public:
+	// constructor : keeps the capacity most recently used solutions
+	SolutionCache(std::size_t capacity = 1 << 16);
+
+	// same results as solver.Solve(puzzle, solution), the solver only runs on a miss
+	// only solved puzzles are cached, for puzzles with several solutions a hit gives one of them
+	SolveStatus Solve(const std::uint8_t* puzzle, std::uint8_t* solution, SudokuSolver& solver);
+
+	// false (solution untouched) if the puzzle is invalid or not cached
+	bool Lookup(const std::uint8_t* puzzle, std::uint8_t* solution);
+	void Insert(const std::uint8_t* puzzle, const std::uint8_t* solution);
+
+	std::uint64_t GetHits();
+	std::uint64_t GetMisses();
+	std::size_t GetSize();
+
+	void Clear();
+
+private:
+	struct Key
+	{
+		std::uint64_t Low, High;
+		bool operator==(const Key& other) const { return Low == other.Low && High == other.High; }
+	};
+
+	struct KeyHash
+	{
+		std::size_t operator()(const Key& key) const { return (std::size_t)key.Low; }
+	};
+
+	// the solution of the canonical puzzle, 4 bits per cell, the transform of every caller maps it back
+	struct Entry
+	{
+		Key Puzzle;
+		std::uint8_t Solution[41];
+	};
+
+	std::mutex Lock;
+	std::list<Entry> Recent;		// most recently used first
+	std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> Entries;
+	std::size_t Capacity;
+	std::uint64_t Hits, Misses;
+
+	static Key Hash(const std::uint8_t* canonical);
+
+	bool Find(const std::uint8_t* canonical, const SudokuTransform& transform, std::uint8_t* solution);
+	void Store(const std::uint8_t* canonical, const SudokuTransform& transform, const std::uint8_t* solution);
+};
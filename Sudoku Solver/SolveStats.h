@@ -0,0 +1,58 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+
+// the solvers only collect statistics when SUDOKU_STATS is defined,
+// otherwise every SOLVE_STATS(...) statement compiles to nothing
+#ifdef SUDOKU_STATS
+#define SOLVE_STATS(...) __VA_ARGS__
+#else
+#define SOLVE_STATS(...)
+#endif
+
+// counters of one solve, reset when the board is loaded
+struct SolveStats
+{
+	std::uint64_t Nodes = 0;			// guesses
+	std::uint64_t Backtracks = 0;		// guessed cells whose values all failed
+	int MaxDepth = 0;					// most cells guessed at the same time
+	std::uint64_t Propagations = 0;		// calls of the singles propagation
+	std::uint64_t NakedSingles = 0;
+	std::uint64_t HiddenSingles = 0;
+
+	// seconds, the search time includes the propagation time
+	double ValidationTime = 0.0;
+	double PropagationTime = 0.0;
+	double SearchTime = 0.0;
+
+	SolveStats& operator+=(const SolveStats& other)
+	{
+		Nodes += other.Nodes;
+		Backtracks += other.Backtracks;
+		MaxDepth = std::max(MaxDepth, other.MaxDepth);
+		Propagations += other.Propagations;
+		NakedSingles += other.NakedSingles;
+		HiddenSingles += other.HiddenSingles;
+		ValidationTime += other.ValidationTime;
+		PropagationTime += other.PropagationTime;
+		SearchTime += other.SearchTime;
+		return *this;
+	}
+};
+
+// adds its own lifetime to a time counter
+class StatsTimer
+{
+public:
+	// constructor
+	StatsTimer(double& total) : Total(total), Start(std::chrono::steady_clock::now()) {}
+
+	// destructor
+	~StatsTimer() { Total += std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count(); }
+
+private:
+	double& Total;
+	std::chrono::steady_clock::time_point Start;
+};
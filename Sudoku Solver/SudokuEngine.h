@@ -0,0 +1,42 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// outcome of solving one puzzle
+enum class SolveStatus : std::uint8_t
+{
+	Solved,
+	Invalid,		// two given values share a row / column / square
+	Unsolvable,		// the given values are consistent but have no solution
+	BudgetExceeded	// the search was stopped by SolveLimits before it could decide
+};
+
+// optional bounds on one search, the defaults leave it unbounded
+struct SolveLimits
+{
+	std::uint64_t MaxNodes = 0;		// search steps (guesses and backtracks), 0 for no limit
+	std::chrono::steady_clock::time_point Deadline = std::chrono::steady_clock::time_point::max();
+	const std::atomic<bool>* Cancel = nullptr;		// the search stops once *Cancel becomes true
+};
+
+// common interface of the solver backends
+// rows, columns and values are 1-based, 0 marks an empty cell
+class SudokuEngine
+{
+public:
+	// destructor
+	virtual ~SudokuEngine() {}
+
+	virtual bool Solve() = 0;
+
+	// number of solutions, the search stops once limit is reached (2 checks for a unique solution)
+	// the table keeps only the given values
+	virtual int CountSolutions(int limit) = 0;
+
+	virtual void SetTableValue(int row, int column, int value) = 0;
+	virtual int GetTableValue(int row, int column) = 0;
+
+	virtual void Clear() = 0;
+};
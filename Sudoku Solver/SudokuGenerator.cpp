@@ -0,0 +1,160 @@
+#include "SudokuGenerator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+template <int BoxHeight, int BoxWidth>
+BasicSudokuGenerator<BoxHeight, BoxWidth>::BasicSudokuGenerator(std::uint64_t seed)
+	: Random(seed), TargetClues(0), Pattern(Symmetry::None)
+{
+
+}
+
+template <int BoxHeight, int BoxWidth>
+void BasicSudokuGenerator<BoxHeight, BoxWidth>::Seed(std::uint64_t seed)
+{
+	Random.seed(seed);
+}
+
+template <int BoxHeight, int BoxWidth>
+void BasicSudokuGenerator<BoxHeight, BoxWidth>::SetTargetClues(int targetClues)
+{
+	TargetClues = targetClues;
+}
+
+template <int BoxHeight, int BoxWidth>
+void BasicSudokuGenerator<BoxHeight, BoxWidth>::SetSymmetry(Symmetry symmetry)
+{
+	Pattern = symmetry;
+}
+
+template <int BoxHeight, int BoxWidth>
+void BasicSudokuGenerator<BoxHeight, BoxWidth>::FillGrid()
+{
+	std::uint8_t values[Size];
+	std::iota(values, values + Size, 1);
+
+	do
+	{
+		// boxes on the diagonal share no row or column, so any values fit in them
+		std::fill(Grid, Grid + Cells, 0);
+
+		for (int box = 0; box < std::min(BoxHeight, BoxWidth); box++)
+		{
+			std::shuffle(values, values + Size, Random);
+
+			for (int i = 0; i < Size; i++)
+				Grid[(box * BoxHeight + i / BoxWidth) * Size + box * BoxWidth + i % BoxWidth] = values[i];
+		}
+	} while (Solver.Solve(Grid, Grid) != SolveStatus::Solved);
+
+	// the solver always tries the low values first, relabel them
+	std::shuffle(values, values + Size, Random);
+	for (int cell = 0; cell < Cells; cell++)
+		Grid[cell] = values[Grid[cell] - 1];
+}
+
+template <int BoxHeight, int BoxWidth>
+int BasicSudokuGenerator<BoxHeight, BoxWidth>::Orbit(int cell, int* orbit)
+{
+	int row = cell / Size, column = cell % Size;
+	int other = cell;
+
+	if (Pattern == Symmetry::Rotational)
+		other = Cells - 1 - cell;
+	else if (Pattern == Symmetry::Mirror)
+		other = row * Size + Size - 1 - column;
+
+	orbit[0] = cell;
+	orbit[1] = other;
+	return (other == cell ? 1 : 2);
+}
+
+template <int BoxHeight, int BoxWidth>
+int BasicSudokuGenerator<BoxHeight, BoxWidth>::Generate(std::uint8_t* puzzle, std::uint8_t* solution)
+{
+	FillGrid();
+	std::copy(Grid, Grid + Cells, Puzzle);
+
+	std::iota(Order, Order + Cells, 0);
+	std::shuffle(Order, Order + Cells, Random);
+
+	int clues = Cells;
+	for (int i = 0; i < Cells && clues > TargetClues; i++)
+	{
+		int orbit[2];
+		int count = Orbit(Order[i], orbit);
+
+		// already removed together with its partner, or would go below the target
+		if (Puzzle[orbit[0]] == 0 || clues - count < TargetClues)
+			continue;
+
+		for (int j = 0; j < count; j++)
+			Puzzle[orbit[j]] = 0;
+
+		if (Solver.CountSolutions(Puzzle, 2) == 1)
+			clues -= count;
+		else
+			for (int j = 0; j < count; j++)
+				Puzzle[orbit[j]] = Grid[orbit[j]];
+	}
+
+	std::copy(Puzzle, Puzzle + Cells, puzzle);
+	if (solution)
+		std::copy(Grid, Grid + Cells, solution);
+
+	return clues;
+}
+
+template <int BoxHeight, int BoxWidth>
+void GeneratePuzzles(std::uint8_t* puzzles, std::uint8_t* solutions, std::size_t count, int targetClues, Symmetry symmetry,
+	std::uint64_t seed, int threads)
+{
+	typedef BasicSudokuGenerator<BoxHeight, BoxWidth> Generator;
+
+	if (threads <= 0)
+		threads = std::max(1u, std::thread::hardware_concurrency());
+	threads = (int)std::min<std::size_t>(threads, count);
+
+	std::atomic<std::size_t> next(0);
+
+	auto worker = [&]()
+	{
+		Generator generator;
+		generator.SetTargetClues(targetClues);
+		generator.SetSymmetry(symmetry);
+
+		// one puzzle at a time, each takes long enough to hand them out one by one
+		for (std::size_t i = next++; i < count; i = next++)
+		{
+			generator.Seed(seed + i);
+			generator.Generate(puzzles + i * Generator::Cells, solutions ? solutions + i * Generator::Cells : nullptr);
+		}
+	};
+
+	// the calling thread is one of the workers
+	std::vector<std::thread> workers;
+	for (int i = 1; i < threads; i++)
+		workers.emplace_back(worker);
+
+	worker();
+
+	for (std::thread& thread : workers)
+		thread.join();
+}
+
+// board geometries compiled into the generator
+template class BasicSudokuGenerator<3, 3>;
+template class BasicSudokuGenerator<4, 4>;
+template class BasicSudokuGenerator<5, 5>;
+template class BasicSudokuGenerator<2, 3>;
+template class BasicSudokuGenerator<3, 4>;
+
+template void GeneratePuzzles<3, 3>(std::uint8_t*, std::uint8_t*, std::size_t, int, Symmetry, std::uint64_t, int);
+template void GeneratePuzzles<4, 4>(std::uint8_t*, std::uint8_t*, std::size_t, int, Symmetry, std::uint64_t, int);
+template void GeneratePuzzles<5, 5>(std::uint8_t*, std::uint8_t*, std::size_t, int, Symmetry, std::uint64_t, int);
+template void GeneratePuzzles<2, 3>(std::uint8_t*, std::uint8_t*, std::size_t, int, Symmetry, std::uint64_t, int);
+template void GeneratePuzzles<3, 4>(std::uint8_t*, std::uint8_t*, std::size_t, int, Symmetry, std::uint64_t, int);
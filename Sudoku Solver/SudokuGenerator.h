@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+
+#include "SudokuSolver.h"
+
+// cells removed together, so the clues of a puzzle form a pattern
+enum class Symmetry
+{
+	None,
+	Rotational,		// 180 degree turn around the center
+	Mirror			// left - right reflection
+};
+
+// makes puzzles with a unique solution : a random full grid, then clues are taken out
+// in random order as long as the solution stays unique
+// instantiated in SudokuGenerator.cpp for the same geometries as BasicSudokuSolver
+template <int BoxHeight, int BoxWidth>
+class BasicSudokuGenerator
+{
+public:
+	static const int Size = BoxHeight * BoxWidth;
+	static const int Cells = Size * Size;
+
+	// constructor
+	BasicSudokuGenerator(std::uint64_t seed = std::random_device()());
+
+	void Seed(std::uint64_t seed);
+
+	// clues are removed until the puzzle has targetClues of them (0 = as few as the solution allows)
+	void SetTargetClues(int targetClues);
+	void SetSymmetry(Symmetry symmetry);
+
+	// writes a new puzzle (row by row, 0 marks an empty cell) and its solution if solution is not nullptr
+	// returns the number of clues, more than the target if no more clue could go
+	int Generate(std::uint8_t* puzzle, std::uint8_t* solution = nullptr);
+
+private:
+	std::mt19937_64 Random;
+	int TargetClues;
+	Symmetry Pattern;
+
+	BasicSudokuSolver<BoxHeight, BoxWidth> Solver;
+	std::uint8_t Grid[Cells], Puzzle[Cells];
+	int Order[Cells];
+
+	void FillGrid();
+
+	// the cells removed together with cell, returns how many
+	int Orbit(int cell, int* orbit);
+};
+
+typedef BasicSudokuGenerator<3, 3> SudokuGenerator;
+
+// generates count puzzles back to back in puzzles (and their solutions if solutions is not nullptr)
+// puzzle i only depends on seed and i, so the output is the same for any number of threads (0 = one per hardware thread)
+template <int BoxHeight, int BoxWidth>
+void GeneratePuzzles(std::uint8_t* puzzles, std::uint8_t* solutions, std::size_t count, int targetClues, Symmetry symmetry,
+	std::uint64_t seed, int threads = 0);
@@ -1,111 +1,617 @@
 #include "SudokuSolver.h"
+#include "BitUtils.h"
 
-#define r first
-#define c second
+#include <algorithm>
 
-SudokuSolver::SudokuSolver()
+template <int BoxHeight, int BoxWidth>
+BasicSudokuSolver<BoxHeight, BoxWidth>::BasicSudokuSolver()
 {
-    Table.resize(MaxNr, std::vector<int>(MaxNr));
-    Column.resize(MaxNr, std::vector<bool>(MaxNr));
-    Row.resize(MaxNr, std::vector<bool>(MaxNr));
-    Square.resize(MaxNr, std::vector<bool>(MaxNr));
+    Clear();
 
-    FoundSolution = false;
+    SolutionCount = 0;
+    SolutionLimit = 1;
+    Stopped = false;
+    Order = CellOrder::MostConstrained;
+    Nodes = 0;
+    NextCheck = 1;
+    Exceeded = false;
+    Depth = 0;
+    Filled = EmptyCount = 0;
 }
 
-int SudokuSolver::GetSquareNumber(int row, int column)
+template <int BoxHeight, int BoxWidth>
+typename BasicSudokuSolver<BoxHeight, BoxWidth>::Mask BasicSudokuSolver<BoxHeight, BoxWidth>::GetCandidates(int cell)
 {
-    return (row - 1) / 3 * 3 + 1 + (column - 1) / 3;
+    return RowMask[Layout.Row[cell]] & ColumnMask[Layout.Column[cell]] & SquareMask[Layout.Square[cell]];
 }
 
-bool SudokuSolver::CanPlace(std::pair<int, int> pos, int value)
+template <int BoxHeight, int BoxWidth>
+void BasicSudokuSolver<BoxHeight, BoxWidth>::MarkPlaced(int cell, Mask bit)
 {
-    return !Row[pos.r][value]
-        && !Column[pos.c][value]
-        && !Square[GetSquareNumber(pos.r, pos.c)][value];
+    // toggles the value : the same call places and removes it
+    RowMask[Layout.Row[cell]] ^= bit;
+    ColumnMask[Layout.Column[cell]] ^= bit;
+    SquareMask[Layout.Square[cell]] ^= bit;
 }
 
-void SudokuSolver::MarkPlaced(std::pair<int, int> pos, int value, bool placed)
+template <int BoxHeight, int BoxWidth>
+void BasicSudokuSolver<BoxHeight, BoxWidth>::Place(int index, Mask bit)
 {
-    Row[pos.r][value] = Column[pos.c][value] = Square[GetSquareNumber(pos.r, pos.c)][value] = placed;
+    // move the cell to the end of the filled part, the remaining empty cells keep their order
+    std::rotate(EmptyCells + Filled, EmptyCells + index, EmptyCells + index + 1);
+    Trail[Filled] = (CellIndex)index;
+
+    int cell = EmptyCells[Filled++];
+    Board[cell] = (std::uint8_t)(CountTrailingZeros(bit) + 1);
+    MarkPlaced(cell, bit);
 }
 
-void SudokuSolver::bkt(int level)
+template <int BoxHeight, int BoxWidth>
+void BasicSudokuSolver<BoxHeight, BoxWidth>::Undo(int filled)
 {
-    if (level == EmptySpaces.size())
+    // take back every placement made after the search had filled cells
+    while (Filled > filled)
     {
-        FoundSolution = true;
-        return;
+        int cell = EmptyCells[--Filled];
+        MarkPlaced(cell, (Mask)(1u << (Board[cell] - 1)));
+        Board[cell] = 0;
+
+        int index = Trail[Filled];
+        std::rotate(EmptyCells + Filled, EmptyCells + Filled + 1, EmptyCells + index + 1);
     }
+}
 
-    for (int i = 1; i < MaxNr; i++)
+template <int BoxHeight, int BoxWidth>
+bool BasicSudokuSolver<BoxHeight, BoxWidth>::Propagate()
+{
+    // place naked and hidden singles until nothing changes
+    // returns false if some cell or some value is left without options
+    SOLVE_STATS(Stats.Propagations++; StatsTimer timer(Stats.PropagationTime);)
+    bool changed = true;
+    while (changed && Filled < EmptyCount)
     {
-        if (CanPlace(EmptySpaces[level], i))
+        changed = false;
+
+        // naked singles : cells with a single candidate
+        for (int i = Filled; i < EmptyCount; i++)
         {
-            Table[EmptySpaces[level].r][EmptySpaces[level].c] = i;
-            MarkPlaced(EmptySpaces[level], i, true);
+            Mask candidates = GetCandidates(EmptyCells[i]);
+            if (!candidates)
+                return false;
 
-            bkt(level + 1);
-            if (FoundSolution)
-                return;
+            if (!(candidates & (candidates - 1)))
+            {
+                Place(i, candidates);
+                SOLVE_STATS(Stats.NakedSingles++;)
+                changed = true;
+            }
+        }
+
+        if (changed)
+            continue;
+
+        // hidden singles : values with a single possible cell in a row / column / square
+        Mask rowOnce[Size] = {}, columnOnce[Size] = {}, squareOnce[Size] = {};
+        Mask rowTwice[Size] = {}, columnTwice[Size] = {}, squareTwice[Size] = {};
+
+        for (int i = Filled; i < EmptyCount; i++)
+        {
+            int cell = EmptyCells[i];
+            int row = Layout.Row[cell], column = Layout.Column[cell], square = Layout.Square[cell];
+            Mask candidates = GetCandidates(cell);
 
-            Table[EmptySpaces[level].r][EmptySpaces[level].c] = 0;
-            MarkPlaced(EmptySpaces[level], i, false);
+            rowTwice[row] |= rowOnce[row] & candidates;
+            rowOnce[row] |= candidates;
+            columnTwice[column] |= columnOnce[column] & candidates;
+            columnOnce[column] |= candidates;
+            squareTwice[square] |= squareOnce[square] & candidates;
+            squareOnce[square] |= candidates;
+        }
+
+        for (int i = 0; i < Size; i++)
+            if ((RowMask[i] & ~rowOnce[i]) || (ColumnMask[i] & ~columnOnce[i]) || (SquareMask[i] & ~squareOnce[i]))
+                return false;
+
+        for (int i = Filled; i < EmptyCount; i++)
+        {
+            int cell = EmptyCells[i];
+            int row = Layout.Row[cell], column = Layout.Column[cell], square = Layout.Square[cell];
+
+            Mask hidden = GetCandidates(cell)
+                & ((rowOnce[row] & ~rowTwice[row]) | (columnOnce[column] & ~columnTwice[column]) | (squareOnce[square] & ~squareTwice[square]));
+            if (!hidden)
+                continue;
+
+            // the cell is the only place for two different values
+            if (hidden & (hidden - 1))
+                return false;
+
+            Place(i, hidden);
+            SOLVE_STATS(Stats.HiddenSingles++;)
+            changed = true;
         }
     }
+
+    return true;
 }
 
-bool SudokuSolver::Solve()
+template <int BoxHeight, int BoxWidth>
+int BasicSudokuSolver<BoxHeight, BoxWidth>::SelectCell()
 {
-    FoundSolution = false;
+    if (Order == CellOrder::RowMajor)
+        return Filled;
 
-    Column.assign(MaxNr, std::vector<bool>(MaxNr, false));
-    Row.assign(MaxNr, std::vector<bool>(MaxNr, false));
-    Square.assign(MaxNr, std::vector<bool>(MaxNr, false));
-    EmptySpaces.clear();
+    // the remaining cell with the fewest candidates
+    // empty cells are kept in row-major order, so ties always go to the same cell
+    int best = Filled;
+    int bestCount = PopCount(GetCandidates(EmptyCells[Filled]));
 
-    for (int i = 1; i < MaxNr; i++)
+    for (int i = Filled + 1; i < EmptyCount && bestCount > 1; i++)
     {
-        for (int j = 1; j < MaxNr; j++)
+        int count = PopCount(GetCandidates(EmptyCells[i]));
+        if (count < bestCount)
         {
-            if (Table[i][j] != 0)
-            {
-                if (Column[j][Table[i][j]])
-                    return false;
+            best = i;
+            bestCount = count;
+        }
+    }
+
+    return best;
+}
 
-                if (Row[i][Table[i][j]])
-                    return false;
+template <int BoxHeight, int BoxWidth>
+bool BasicSudokuSolver<BoxHeight, BoxWidth>::CheckLimits()
+{
+    if (Limits.MaxNodes != 0 && Nodes > Limits.MaxNodes)
+        return true;
 
-                if (Square[GetSquareNumber(i, j)][Table[i][j]])
-                    return false;
+    if (Limits.Cancel && Limits.Cancel->load(std::memory_order_relaxed))
+        return true;
 
-                Column[j][Table[i][j]] = true;
-                Row[i][Table[i][j]] = true;
-                Square[GetSquareNumber(i, j)][Table[i][j]] = true;
-            }
-            else
-            {
-                EmptySpaces.push_back({ i, j });
-            }
+    if (Limits.Deadline != std::chrono::steady_clock::time_point::max() && std::chrono::steady_clock::now() >= Limits.Deadline)
+        return true;
+
+    // next node at which a limit could run out
+    NextCheck = Nodes + CheckInterval;
+    if (Limits.MaxNodes != 0)
+        NextCheck = std::min(NextCheck, Limits.MaxNodes + 1);
+
+    return false;
+}
+
+template <int BoxHeight, int BoxWidth>
+void BasicSudokuSolver<BoxHeight, BoxWidth>::Push()
+{
+    Frame& frame = Stack[Depth++];
+    SOLVE_STATS(Stats.MaxDepth = std::max(Stats.MaxDepth, Depth);)
+
+    frame.Filled = Filled;
+    frame.Selected = SelectCell();
+    frame.Candidates = GetCandidates(EmptyCells[frame.Selected]);
+}
+
+template <int BoxHeight, int BoxWidth>
+StepResult BasicSudokuSolver<BoxHeight, BoxWidth>::Advance()
+{
+    Frame& frame = Stack[Depth - 1];
+
+    // take back the previous guess of this cell and every single it forced
+    Undo(frame.Filled);
+
+    if (!frame.Candidates)
+    {
+        SOLVE_STATS(Stats.Backtracks++;)
+        Depth--;
+        return (Depth == 0 ? StepResult::Unsolvable : StepResult::Backtracked);
+    }
+
+    // walk the free values from the lowest bit up
+    Mask bit = frame.Candidates & (~frame.Candidates + 1);
+    frame.Candidates ^= bit;
+
+    Place(frame.Selected, bit);
+    SOLVE_STATS(Stats.Nodes++;)
+
+    if (Propagate())
+    {
+        if (Filled == EmptyCount)
+        {
+            SolutionCount++;
+            Stopped = (SolutionCount >= SolutionLimit);
+            return StepResult::Solved;
         }
+
+        Push();
     }
 
-    bkt(0);
-    return FoundSolution;
+    return StepResult::Placed;
 }
 
-void SudokuSolver::SetTableValue(int row, int column, int value)
+template <int BoxHeight, int BoxWidth>
+void BasicSudokuSolver<BoxHeight, BoxWidth>::bkt()
 {
-    Table[row][column] = value;
+    while (Depth > 0 && !Stopped)
+    {
+        if (++Nodes >= NextCheck && CheckLimits())
+        {
+            Stopped = Exceeded = true;
+            return;
+        }
+
+        Advance();
+    }
 }
 
-int SudokuSolver::GetTableValue(int row, int column)
+template <int BoxHeight, int BoxWidth>
+bool BasicSudokuSolver<BoxHeight, BoxWidth>::LoadGivens()
 {
-    return Table[row][column];
+    // rebuild the search state from the values on the board
+    SOLVE_STATS(Stats = SolveStats(); StatsTimer timer(Stats.ValidationTime);)
+    Exceeded = false;
+    for (int i = 0; i < Size; i++)
+        RowMask[i] = ColumnMask[i] = SquareMask[i] = AllValues;
+    Filled = EmptyCount = 0;
+
+    for (int cell = 0; cell < Cells; cell++)
+    {
+        if (Board[cell] > Size)
+            return false;
+
+        if (Board[cell] != 0)
+        {
+            Mask bit = (Mask)(1u << (Board[cell] - 1));
+
+            // value already used in this row / column / square
+            if (!(GetCandidates(cell) & bit))
+                return false;
+
+            MarkPlaced(cell, bit);
+        }
+        else
+        {
+            EmptyCells[EmptyCount++] = (CellIndex)cell;
+        }
+    }
+
+    return true;
+}
+
+template <int BoxHeight, int BoxWidth>
+bool BasicSudokuSolver<BoxHeight, BoxWidth>::LoadTable()
+{
+    SOLVE_STATS(Stats = SolveStats(); StatsTimer timer(Stats.ValidationTime);)
+    Exceeded = false;
+
+    Track();
+    if (ConflictCount > 0)
+        return false;
+
+    // the masks are already up to date, only the empty cells are collected
+    Filled = EmptyCount = 0;
+
+    for (int cell = 0; cell < Cells; cell++)
+        if (Board[cell] == 0)
+            EmptyCells[EmptyCount++] = (CellIndex)cell;
+
+    return true;
 }
 
-void SudokuSolver::Clear()
+template <int BoxHeight, int BoxWidth>
+void BasicSudokuSolver<BoxHeight, BoxWidth>::AddValue(int cell, int value)
 {
-    Table.assign(MaxNr, std::vector<int>(MaxNr, 0));
+    Mask bit = (Mask)(1u << (value - 1));
+    int units[3] = { Layout.Row[cell], Size + Layout.Column[cell], 2 * Size + Layout.Square[cell] };
+    Mask* masks[3] = { &RowMask[Layout.Row[cell]], &ColumnMask[Layout.Column[cell]], &SquareMask[Layout.Square[cell]] };
+
+    for (int i = 0; i < 3; i++)
+    {
+        int count = ++ValueCount[units[i]][value - 1];
+
+        if (count == 1)
+            *masks[i] &= (Mask)~bit;
+        else if (count == 2)
+            ConflictCount++;
+    }
+}
+
+template <int BoxHeight, int BoxWidth>
+void BasicSudokuSolver<BoxHeight, BoxWidth>::RemoveValue(int cell, int value)
+{
+    Mask bit = (Mask)(1u << (value - 1));
+    int units[3] = { Layout.Row[cell], Size + Layout.Column[cell], 2 * Size + Layout.Square[cell] };
+    Mask* masks[3] = { &RowMask[Layout.Row[cell]], &ColumnMask[Layout.Column[cell]], &SquareMask[Layout.Square[cell]] };
+
+    for (int i = 0; i < 3; i++)
+    {
+        int count = --ValueCount[units[i]][value - 1];
+
+        if (count == 0)
+            *masks[i] |= bit;
+        else if (count == 1)
+            ConflictCount--;
+    }
+}
+
+template <int BoxHeight, int BoxWidth>
+void BasicSudokuSolver<BoxHeight, BoxWidth>::Track()
+{
+    if (Tracked)
+        return;
+
+    // the board was overwritten as a whole : count every value again
+    for (int i = 0; i < Size; i++)
+        RowMask[i] = ColumnMask[i] = SquareMask[i] = AllValues;
+    std::fill(&ValueCount[0][0], &ValueCount[0][0] + Geometry::Units * Size, 0);
+    ConflictCount = 0;
+
+    for (int cell = 0; cell < Cells; cell++)
+    {
+        if (Board[cell] > Size)
+            Board[cell] = 0;
+
+        if (Board[cell] != 0)
+            AddValue(cell, Board[cell]);
+    }
+
+    Tracked = true;
+}
+
+template <int BoxHeight, int BoxWidth>
+void BasicSudokuSolver<BoxHeight, BoxWidth>::Search(int limit)
+{
+    SOLVE_STATS(StatsTimer timer(Stats.SearchTime);)
+
+    SolutionCount = 0;
+    SolutionLimit = limit;
+    Stopped = false;
+
+    // the first node checks the limits, so an expired deadline or a raised token stops at once
+    Nodes = 0;
+    NextCheck = 1;
+
+    Depth = 0;
+
+    // most puzzles are solved by singles alone and never reach bkt
+    if (!Propagate())
+        return;
+
+    if (Filled == EmptyCount)
+    {
+        SolutionCount = 1;
+        Stopped = (SolutionCount >= SolutionLimit);
+        return;
+    }
+
+    Push();
+    bkt();
+}
+
+template <int BoxHeight, int BoxWidth>
+bool BasicSudokuSolver<BoxHeight, BoxWidth>::Solve()
+{
+    if (!LoadTable())
+        return false;
+
+    Search(1);
+
+    // leave only the given values on the board if there is no solution
+    if (SolutionCount == 0)
+    {
+        Undo(0);
+        return false;
+    }
+
+    // the placed values become part of the board
+    for (int i = 0; i < Filled; i++)
+        AddValue(EmptyCells[i], Board[EmptyCells[i]]);
+
+    return true;
+}
+
+template <int BoxHeight, int BoxWidth>
+SolveStatus BasicSudokuSolver<BoxHeight, BoxWidth>::Solve(const std::uint8_t* puzzle, std::uint8_t* solution)
+{
+    std::copy(puzzle, puzzle + Cells, Board);
+    Tracked = false;
+
+    SolveStatus status = SolveStatus::Invalid;
+    if (LoadGivens())
+    {
+        Search(1);
+        status = SolveStatus::Solved;
+
+        if (SolutionCount == 0)
+        {
+            Undo(0);
+            status = (Exceeded ? SolveStatus::BudgetExceeded : SolveStatus::Unsolvable);
+        }
+    }
+
+    std::copy(Board, Board + Cells, solution);
+    return status;
+}
+
+template <int BoxHeight, int BoxWidth>
+int BasicSudokuSolver<BoxHeight, BoxWidth>::CountSolutions(int limit)
+{
+    if (!LoadTable())
+        return 0;
+
+    Search(limit);
+
+    // the board is left with the given values only
+    Undo(0);
+
+    return SolutionCount;
+}
+
+template <int BoxHeight, int BoxWidth>
+int BasicSudokuSolver<BoxHeight, BoxWidth>::CountSolutions(const std::uint8_t* puzzle, int limit)
+{
+    std::copy(puzzle, puzzle + Cells, Board);
+    Tracked = false;
+
+    if (!LoadGivens())
+        return 0;
+
+    Search(limit);
+
+    // the board is left with the given values only
+    Undo(0);
+
+    return SolutionCount;
+}
+
+template <int BoxHeight, int BoxWidth>
+void BasicSudokuSolver<BoxHeight, BoxWidth>::SetLimits(const SolveLimits& limits)
+{
+    Limits = limits;
+}
+
+template <int BoxHeight, int BoxWidth>
+const SolveStats& BasicSudokuSolver<BoxHeight, BoxWidth>::GetStats()
+{
+    return Stats;
+}
+
+template <int BoxHeight, int BoxWidth>
+bool BasicSudokuSolver<BoxHeight, BoxWidth>::BudgetExceeded()
+{
+    return Exceeded;
+}
+
+template <int BoxHeight, int BoxWidth>
+std::uint64_t BasicSudokuSolver<BoxHeight, BoxWidth>::GetNodes()
+{
+    return Nodes;
+}
+
+template <int BoxHeight, int BoxWidth>
+bool BasicSudokuSolver<BoxHeight, BoxWidth>::StartSteps()
+{
+    if (!LoadTable())
+        return false;
+
+    SolutionCount = 0;
+    SolutionLimit = 1;
+    Stopped = false;
+    Depth = 0;
+
+    if (!Propagate())
+        Undo(0);
+    else if (Filled == EmptyCount)
+        SolutionCount = 1;
+    else
+        Push();
+
+    // solved or failed by singles alone : the first Step reports it
+    if (SolutionCount > 0)
+        for (int i = 0; i < Filled; i++)
+            AddValue(EmptyCells[i], Board[EmptyCells[i]]);
+
+    return true;
+}
+
+template <int BoxHeight, int BoxWidth>
+StepResult BasicSudokuSolver<BoxHeight, BoxWidth>::Step()
+{
+    // the search is over, keep reporting how it ended
+    if (Depth == 0)
+        return (SolutionCount > 0 ? StepResult::Solved : StepResult::Unsolvable);
+
+    StepResult result = Advance();
+
+    if (result == StepResult::Solved)
+    {
+        // the placed values become part of the board, as after Solve
+        for (int i = 0; i < Filled; i++)
+            AddValue(EmptyCells[i], Board[EmptyCells[i]]);
+        Depth = 0;
+    }
+    else if (result == StepResult::Unsolvable)
+    {
+        Undo(0);
+    }
+
+    return result;
+}
+
+template <int BoxHeight, int BoxWidth>
+void BasicSudokuSolver<BoxHeight, BoxWidth>::StopSteps()
+{
+    if (Depth == 0)
+        return;
+
+    Undo(0);
+    Depth = 0;
+    SolutionCount = 0;
+}
+
+template <int BoxHeight, int BoxWidth>
+void BasicSudokuSolver<BoxHeight, BoxWidth>::SetCellOrder(CellOrder order)
+{
+    Order = order;
+}
+
+template <int BoxHeight, int BoxWidth>
+void BasicSudokuSolver<BoxHeight, BoxWidth>::SetTableValue(int row, int column, int value)
+{
+    if (value < 0 || value > Size)
+        return;
+
+    Track();
+
+    // only the cell's row, column and square change
+    int cell = (row - 1) * Size + column - 1;
+    if (Board[cell] != 0)
+        RemoveValue(cell, Board[cell]);
+
+    Board[cell] = (std::uint8_t)value;
+    if (value != 0)
+        AddValue(cell, value);
+}
+
+template <int BoxHeight, int BoxWidth>
+int BasicSudokuSolver<BoxHeight, BoxWidth>::GetTableValue(int row, int column)
+{
+    return Board[(row - 1) * Size + column - 1];
+}
+
+template <int BoxHeight, int BoxWidth>
+bool BasicSudokuSolver<BoxHeight, BoxWidth>::IsValid()
+{
+    Track();
+    return ConflictCount == 0;
+}
+
+template <int BoxHeight, int BoxWidth>
+bool BasicSudokuSolver<BoxHeight, BoxWidth>::IsConflicting(int row, int column)
+{
+    Track();
+
+    int cell = (row - 1) * Size + column - 1;
+    int value = Board[cell];
+    if (value == 0)
+        return false;
+
+    return ValueCount[Layout.Row[cell]][value - 1] > 1 || ValueCount[Size + Layout.Column[cell]][value - 1] > 1 || ValueCount[2 * Size + Layout.Square[cell]][value - 1] > 1;
+}
+
+template <int BoxHeight, int BoxWidth>
+void BasicSudokuSolver<BoxHeight, BoxWidth>::Clear()
+{
+    std::fill(Board, Board + Cells, 0);
+
+    for (int i = 0; i < Size; i++)
+        RowMask[i] = ColumnMask[i] = SquareMask[i] = AllValues;
+    std::fill(&ValueCount[0][0], &ValueCount[0][0] + Geometry::Units * Size, 0);
+    ConflictCount = 0;
+    Tracked = true;
 }
 
+// board geometries compiled into the solver
+template class BasicSudokuSolver<3, 3>;
+template class BasicSudokuSolver<4, 4>;
+template class BasicSudokuSolver<5, 5>;
+template class BasicSudokuSolver<2, 3>;
+template class BasicSudokuSolver<3, 4>;
@@ -1,32 +1,156 @@
 #pragma once
 
-#include <iostream>
-#include <vector>
+#include <cstdint>
+#include <type_traits>
 
-class SudokuSolver
+#include "BoardGeometry.h"
+#include "SolveStats.h"
+#include "SudokuEngine.h"
+
+// order in which bkt picks the next empty cell
+enum class CellOrder
+{
+	RowMajor,			// first empty cell, row by row
+	MostConstrained		// empty cell with the fewest candidates, lowest row / column on ties
+};
+
+// what one Step of the resumable search did
+enum class StepResult
+{
+	Placed,			// a guess was placed together with the singles it forces
+	Backtracked,	// every value of the last guessed cell failed, the search went one cell back
+	Solved,			// the board is full, the values stay on the board as after Solve
+	Unsolvable		// every guess failed, the board holds the givens again
+};
+
+// backtracking solver for a board made of BoxHeight x BoxWidth boxes
+// the board has BoxHeight * BoxWidth rows, columns and values
+// instantiated in SudokuSolver.cpp for 3x3, 4x4, 5x5, 2x3 and 3x4 boxes
+template <int BoxHeight, int BoxWidth>
+class BasicSudokuSolver : public SudokuEngine
 {
 public:
+	static const int Size = BoxHeight * BoxWidth;
+	static const int Cells = Size * Size;
+
 	// constructor
-	SudokuSolver();
+	BasicSudokuSolver();
+
+	bool Solve() override;
+
+	// solve a whole board given row by row, 0 marks an empty cell
+	// solution receives the solved board, or the givens if there is no solution, and may be the puzzle itself
+	SolveStatus Solve(const std::uint8_t* puzzle, std::uint8_t* solution);
+
+	int CountSolutions(int limit) override;
+	int CountSolutions(const std::uint8_t* puzzle, int limit);
+
+	void SetCellOrder(CellOrder order);
+
+	// resumable search, for drawing the board while it is solved
+	// StartSteps loads the board like Solve (false if values repeat), then every Step makes one move
+	// and costs one guess with its propagation, StopSteps gives up and leaves only the givens
+	bool StartSteps();
+	StepResult Step();
+	void StopSteps();
+
+	// bounds every following Solve / CountSolutions, MaxNodes counts per call
+	void SetLimits(const SolveLimits& limits);
+
+	// true if the last search was stopped by the limits (CountSolutions then returns a lower bound)
+	bool BudgetExceeded();
+
+	// search steps of the last Solve / CountSolutions as MaxNodes counts them, also without SUDOKU_STATS
+	std::uint64_t GetNodes();
 
-	bool Solve();
+	// counters of the last solve, all 0 unless built with SUDOKU_STATS
+	const SolveStats& GetStats();
 
-	void SetTableValue(int row, int column, int value);
-	int GetTableValue(int row, int column);
+	// every edit keeps the row / column / square state up to date, values outside 0..Size are ignored
+	void SetTableValue(int row, int column, int value) override;
+	int GetTableValue(int row, int column) override;
 
-	void Clear();
+	// false while some value repeats in a row / column / square
+	bool IsValid();
+
+	// true if the value in the cell repeats in its row, column or square
+	bool IsConflicting(int row, int column);
+
+	void Clear() override;
 
 private:
-	const int MaxNr = 10;
-	std::vector<std::vector<int>> Table;
-	std::vector<std::vector<bool>> Column, Row, Square;
-	std::vector<std::pair<int, int>> EmptySpaces;
+	typedef BoardGeometry<BoxHeight, BoxWidth> Geometry;
+	typedef typename Geometry::CellIndex CellIndex;
+	static constexpr Geometry Layout = Geometry();
+
+	// smallest mask type with one bit for every value
+	typedef typename std::conditional<(Size <= 16), std::uint16_t, std::uint32_t>::type Mask;
+	static const Mask AllValues = (Mask)((1u << Size) - 1);		// bit (value - 1) set for every value 1..Size
+
+	// flat board, row by row, 0 marks an empty cell
+	std::uint8_t Board[Cells];
+
+	// EmptyCells[0, Filled) holds the cells placed by the search, in placement order,
+	// EmptyCells[Filled, EmptyCount) the cells still empty, in row-major order
+	CellIndex EmptyCells[Cells];
+	CellIndex Trail[Cells];		// index each placed cell was taken from, used to undo the placement
+	int Filled, EmptyCount;
+
+	// candidate masks : bit (value - 1) is set while value is still free in that row / column / square
+	Mask RowMask[Size], ColumnMask[Size], SquareMask[Size];
+
+	// explicit search stack : one frame per guessed cell, so the search can pause and resume at any depth
+	struct Frame
+	{
+		int Filled;				// cells filled before the guess
+		int Selected;			// index of the guessed cell in EmptyCells
+		Mask Candidates;		// values not tried yet
+	};
+	Frame Stack[Cells];
+	int Depth;
+
+	void Push();
+	StepResult Advance();
+	void bkt();
+	int SolutionCount, SolutionLimit;
+	bool Stopped;		// solution limit reached or limits exceeded
+	CellOrder Order;
+
+	// the node count is compared on every node, the clock and the cancel token only every CheckInterval nodes
+	static const std::uint64_t CheckInterval = 1024;
+	SolveLimits Limits;
+	std::uint64_t Nodes, NextCheck;
+	bool Exceeded;
+
+	bool CheckLimits();
+
+	SolveStats Stats;
+
+	// number of cells holding each value in every row, column and square (numbered as in Layout.UnitCells)
+	std::uint8_t ValueCount[Geometry::Units][Size];
+	int ConflictCount;		// values held by more than one cell of a unit
+	bool Tracked;			// false after a whole board was loaded : ValueCount has to be rebuilt
+
+	void Track();
+	void AddValue(int cell, int value);
+	void RemoveValue(int cell, int value);
+
+	bool LoadGivens();		// whole board : rebuilds the masks, false if the givens clash
+	bool LoadTable();		// board edited by SetTableValue : reuses the tracked masks, false if values repeat
+	void Search(int limit);
+
+	int SelectCell();
+	bool Propagate();
 
-	void bkt(int level);
-	bool FoundSolution;
+	void Place(int index, Mask bit);
+	void Undo(int filled);
 
-	int GetSquareNumber(int row, int column);
-	bool CanPlace(std::pair<int, int> pos, int value);
-	void MarkPlaced(std::pair<int, int> pos, int value, bool placed);
+	Mask GetCandidates(int cell);
+	void MarkPlaced(int cell, Mask bit);
 };
 
+typedef BasicSudokuSolver<3, 3> SudokuSolver;
+typedef BasicSudokuSolver<4, 4> HexadokuSolver;
+typedef BasicSudokuSolver<5, 5> Sudoku25Solver;
+typedef BasicSudokuSolver<2, 3> Sudoku6Solver;
+typedef BasicSudokuSolver<3, 4> Sudoku12Solver;
@@ -5,9 +5,15 @@
 #include <ft2build.h>
 #include FT_FREETYPE_H
 
+#include <algorithm>
 #include <iostream>
+#include <vector>
+
+// width of the glyph atlas in pixels, glyphs are packed in rows as tall as their tallest glyph
+const int AtlasWidth = 1024;
 
 TextRenderer::TextRenderer(unsigned int width, unsigned int height)
+	: BufferSize(0), Atlas(0), Characters(), CapHeight(0)
 {
 	// load and configure shader
 	ResourceManager::LoadShader("shaders/text_2D.vert", "shaders/text_2D.frag", nullptr, "text");
@@ -20,11 +26,12 @@ TextRenderer::TextRenderer(unsigned int width, unsigned int height)
 	glGenBuffers(1, &VBO);
 
 	glBindBuffer(GL_ARRAY_BUFFER, VBO);
-	glBufferData(GL_ARRAY_BUFFER, 24 * sizeof(float), NULL, GL_DYNAMIC_DRAW);
 
 	glBindVertexArray(VAO);
 	glEnableVertexAttribArray(0);
-	glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+	glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 7 * sizeof(float), (void*)0);
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 7 * sizeof(float), (void*)(4 * sizeof(float)));
 
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 	glBindVertexArray(0);
@@ -33,9 +40,10 @@ TextRenderer::TextRenderer(unsigned int width, unsigned int height)
 void TextRenderer::Load(std::string font, unsigned int fontSize)
 {
 	// clear the previously loaded Characters
-	for (auto ch : Characters)
-		glDeleteTextures(1, &ch.second.TextureID);
-	Characters.clear();
+	if (Atlas)
+		glDeleteTextures(1, &Atlas);
+	Atlas = 0;
+	std::fill(Characters, Characters + 128, Character());
 
 	// initialize and load the FreeType library
 	FT_Library ft;
@@ -49,10 +57,11 @@ void TextRenderer::Load(std::string font, unsigned int fontSize)
 	// set size to load guphs as
 	FT_Set_Pixel_Sizes(face, 0, fontSize);
 
-	// disable byte-alignment restriction
-	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	// render the first 128 ASCII characters and place them in the atlas, one pixel apart so filtering does not bleed
+	std::vector<std::vector<unsigned char>> bitmaps(128);
+	std::vector<glm::ivec2> positions(128, glm::ivec2(0));
+	int penX = 1, penY = 1, rowHeight = 0;
 
-	// precompile first 128 ASCII characters
 	for (GLubyte c = 0; c < 128; c++)
 	{
 		// load character glyph
@@ -62,26 +71,59 @@ void TextRenderer::Load(std::string font, unsigned int fontSize)
 			continue;
 		}
 
-		// generate texture
-		GLuint texture;
-		glGenTextures(1, &texture);
-		glBindTexture(GL_TEXTURE_2D, texture);
+		FT_Bitmap& bitmap = face->glyph->bitmap;
+		if (penX + (int)bitmap.width + 1 > AtlasWidth)
+		{
+			penX = 1;
+			penY += rowHeight + 1;
+			rowHeight = 0;
+		}
+
+		positions[c] = glm::ivec2(penX, penY);
+		penX += bitmap.width + 1;
+		rowHeight = std::max(rowHeight, (int)bitmap.rows);
 
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, face->glyph->bitmap.width, face->glyph->bitmap.rows, 0, GL_RED, GL_UNSIGNED_BYTE, face->glyph->bitmap.buffer);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		bitmaps[c].resize(bitmap.width * bitmap.rows);
+		for (unsigned int row = 0; row < bitmap.rows; row++)
+			std::copy(bitmap.buffer + row * bitmap.pitch, bitmap.buffer + row * bitmap.pitch + bitmap.width, bitmaps[c].begin() + row * bitmap.width);
 
 		// store the character
-		Character character = {
-			texture,
-			glm::ivec2(face->glyph->bitmap.width, face->glyph->bitmap.rows),
-			glm::ivec2(face->glyph->bitmap_left, face->glyph->bitmap_top),
-			face->glyph->advance.x
-		};
-		Characters.insert(std::pair<char, Character>(c, character));
+		Character& character = Characters[c];
+		character.Size = glm::ivec2(bitmap.width, bitmap.rows);
+		character.Bearing = glm::ivec2(face->glyph->bitmap_left, face->glyph->bitmap_top);
+		character.Advance = (unsigned int)face->glyph->advance.x;
+	}
+
+	CapHeight = Characters['H'].Bearing.y;
+
+	// copy the glyphs into the atlas
+	int atlasHeight = penY + rowHeight + 1;
+	std::vector<unsigned char> pixels(AtlasWidth * atlasHeight, 0);
+
+	for (int c = 0; c < 128; c++)
+	{
+		Character& character = Characters[c];
+		for (int row = 0; row < character.Size.y; row++)
+			std::copy(bitmaps[c].begin() + row * character.Size.x, bitmaps[c].begin() + (row + 1) * character.Size.x,
+				pixels.begin() + (positions[c].y + row) * AtlasWidth + positions[c].x);
+
+		character.TexOrigin = glm::vec2((float)positions[c].x / AtlasWidth, (float)positions[c].y / atlasHeight);
+		character.TexSize = glm::vec2((float)character.Size.x / AtlasWidth, (float)character.Size.y / atlasHeight);
 	}
+
+	// disable byte-alignment restriction
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+	// generate texture
+	glGenTextures(1, &Atlas);
+	glBindTexture(GL_TEXTURE_2D, Atlas);
+
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, AtlasWidth, atlasHeight, 0, GL_RED, GL_UNSIGNED_BYTE, pixels.data());
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
 	glBindTexture(GL_TEXTURE_2D, 0);
 
 	// destroy FreeType
@@ -89,52 +131,81 @@ void TextRenderer::Load(std::string font, unsigned int fontSize)
 	FT_Done_FreeType(ft);
 }
 
-void TextRenderer::RenderText(std::string text, float x, float y, float scale, glm::vec3 color)
+void TextRenderer::RenderText(std::string_view text, float x, float y, float scale, glm::vec3 color)
 {
-	ResourceManager::GetShader("text").Use();
-	ResourceManager::GetShader("text").SetVector3f("textColor", color);
-
-	glActiveTexture(GL_TEXTURE0);
-	glBindVertexArray(VAO);
-
 	// iterate through all characters
-	for (std::string::const_iterator c = text.begin(); c != text.end(); c++)
+	for (char c : text)
 	{
-		Character ch = Characters[*c];
+		const Character& ch = Characters[(unsigned char)c & 127];
 
 		float xpos = x + ch.Bearing.x * scale;
-		float ypos = y + (Characters['H'].Bearing.y - ch.Bearing.y) * scale;
+		float ypos = y + (CapHeight - ch.Bearing.y) * scale;
 
 		float w = ch.Size.x * scale;
 		float h = ch.Size.y * scale;
 
-		// update VBO
-		float vertices[6][4] = {
-			{ xpos,		ypos + h,	0.0f, 1.0f },
-			{ xpos + w,	ypos,		1.0f, 0.0f },
-			{ xpos,		ypos,		0.0f, 0.0f },
+		float u0 = ch.TexOrigin.x, v0 = ch.TexOrigin.y;
+		float u1 = u0 + ch.TexSize.x, v1 = v0 + ch.TexSize.y;
+
+		float vertices[6][7] = {
+			{ xpos,		ypos + h,	u0, v1,		color.r, color.g, color.b },
+			{ xpos + w,	ypos,		u1, v0,		color.r, color.g, color.b },
+			{ xpos,		ypos,		u0, v0,		color.r, color.g, color.b },
 
-			{ xpos,		ypos + h,	0.0f, 1.0f },
-			{ xpos + w, ypos + h,	1.0f, 1.0f },
-			{ xpos + w,	ypos,		1.0f, 0.0f }
+			{ xpos,		ypos + h,	u0, v1,		color.r, color.g, color.b },
+			{ xpos + w, ypos + h,	u1, v1,		color.r, color.g, color.b },
+			{ xpos + w,	ypos,		u1, v0,		color.r, color.g, color.b }
 		};
+		Vertices.insert(Vertices.end(), &vertices[0][0], &vertices[0][0] + 6 * 7);
 
-		// render glyph texture over quad
-		glBindTexture(GL_TEXTURE_2D, ch.TextureID);
+		// advance cursors for next glyph
+		x += (ch.Advance >> 6) * scale;
+	}
+}
+
+void TextRenderer::Flush()
+{
+	if (Vertices.empty())
+		return;
 
-		// update content of VBO memory
-		glBindBuffer(GL_ARRAY_BUFFER, VBO);
-		glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	ResourceManager::GetShader("text").Use();
 
-		// render quad
-		glDrawArrays(GL_TRIANGLES, 0, 6);
+	// the atlas is bound once for all the text of the frame
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, Atlas);
+	glBindVertexArray(VAO);
 
-		// advance cursors for next glyph
-		x += (ch.Advance >> 6) * scale;
+	// the buffer only grows, smaller batches overwrite the start of it
+	std::size_t size = Vertices.size() * sizeof(float);
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	if (size > BufferSize)
+	{
+		BufferSize = size * 2;
+		glBufferData(GL_ARRAY_BUFFER, BufferSize, NULL, GL_DYNAMIC_DRAW);
 	}
+	glBufferSubData(GL_ARRAY_BUFFER, 0, size, Vertices.data());
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	// render quads
+	glDrawArrays(GL_TRIANGLES, 0, (GLsizei)(Vertices.size() / 7));
 
 	glBindTexture(GL_TEXTURE_2D, 0);
 	glBindVertexArray(0);
+
+	Vertices.clear();
+}
+
+const Character& TextRenderer::GetCharacter(char c) const
+{
+	return Characters[(unsigned char)c & 127];
+}
+
+GLuint TextRenderer::GetAtlas() const
+{
+	return Atlas;
 }
 
+int TextRenderer::GetCapHeight() const
+{
+	return CapHeight;
+}
@@ -3,13 +3,16 @@
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 
-#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
 
 #include "Shader.h"
 
 struct Character
 {
-	GLuint TextureID;		// ID handle of the glyph texture
+	glm::vec2 TexOrigin;	// top left corner of the glyph in the atlas, in texture coordinates
+	glm::vec2 TexSize;		// size of the glyph in the atlas, in texture coordinates
 	glm::ivec2 Size;		// size of glyph
 	glm::ivec2 Bearing;		// offset from baseline to left/top of glyph
 	unsigned int Advance;	// horizontal offset to advance to next glyph
@@ -24,14 +27,30 @@ public:
 	// pre-compile a list of characters from given font
 	void Load(std::string font, unsigned int fontSize);
 
-	// render aa string of text using the precompiled list of characters
-	void RenderText(std::string text, float x, float y, float scale, glm::vec3 color = glm::vec3(1.0f));
+	// queue a string of text using the precompiled list of characters, it is drawn by the next Flush
+	void RenderText(std::string_view text, float x, float y, float scale, glm::vec3 color = glm::vec3(1.0f));
+
+	// draw every string queued since the last Flush with one upload and one draw call
+	void Flush();
+
+	// glyph data for renderers that draw from the same atlas
+	const Character& GetCharacter(char c) const;
+	GLuint GetAtlas() const;
+	int GetCapHeight() const;
 
 private:
 	// render state
 	GLuint VAO, VBO;
+	std::size_t BufferSize;			// bytes allocated for VBO
+
+	// queued glyph quads : position, texture coordinates and color per vertex
+	std::vector<float> Vertices;
+
+	// every glyph is packed in one texture, so a string never rebinds it
+	GLuint Atlas;
 
-	// list of precompiled Characters
-	std::map<char, Character> Characters;
+	// precompiled Characters, indexed by ASCII code
+	Character Characters[128];
+	int CapHeight;		// bearing of 'H', every glyph is aligned to it
 };
 
@@ -5,18 +5,25 @@
 #include <glm/gtc/matrix_transform.hpp>
 
 #include <iostream>
+#include <chrono>
 #include <cmath>
 #include <vector>
 
 #include "ResourceManager.h"
 #include "SudokuSolver.h"
+#include "AsyncSolver.h"
+#include "SudokuGenerator.h"
 #include "TextRenderer.h"
+#include "GridRenderer.h"
+#include "CellRenderer.h"
 #include "Button.h"
 
 // callback
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mode);
 void mouse_button_callback(GLFWwindow* window, int button, int action, int mods);
+void cursor_position_callback(GLFWwindow* window, double xpos, double ypos);
+void window_refresh_callback(GLFWwindow* window);
 
 // utility functions
 void Init();
@@ -33,29 +40,65 @@ double lastFrame = 0.0f;		// time of last frame
 // mouse variables
 double MouseX, MouseY;
 
+// on demand rendering : frames are only drawn when something changed, the loop sleeps in between
+bool RenderOnDemand = true;		// false draws every frame as fast as possible
+bool Redraw = true;				// set by input, solver progress and the status text
+const double SolvePollInterval = 1.0 / 60.0;		// how often a running solve is checked while idle
+
+void WaitEvents();
+
 // table
 int SquareSize = 70;
 int TableUpX = (SCR_WIDTH - 9 * SquareSize) / 2;
 int TableUpY = 130;
 
+GridRenderer* Grid;		// the lines of the table
+CellRenderer* Digits;	// the values of the table
+
 void DrawTable();
 bool InTable();
 
 // Sudoku Solver
 SudokuSolver* Sudoku;
+AsyncSudokuSolver<3, 3>* Solving;		// solves a copy of the board off the render thread
+
+void StartSolve();
+bool FinishSolve();
+
+// step by step solve, drawn as it goes
+bool Animating = false;
+int StepsPerFrame = 1;		// up / down arrows double / halve it
+
+bool AnimateSolve();
+bool BoardLocked();
+
+// fresh puzzles for the New button
+SudokuGenerator* Generator;
+void NewPuzzle();
+
+// counters of the last solve, drawn under the table when built with SUDOKU_STATS
+SolveStats LastStats;
+void DrawStats();
 
 // Text Renderer
 TextRenderer* RenderText;
 
 // Buttons
 Button* SolveButton;
+Button* StepsButton;
 Button* ClearButton;
+Button* NewButton;
 
 void DrawButtons();
 
 float TextTimer = 2.0f;
-float Timer = TextTimer;
-bool SudokuError;
+float Timer = TextTimer;		// seconds the status text has been up, at most TextTimer
+double TextStart = -TextTimer;	// glfwGetTime() when the status text was set
+SolveStatus LastStatus;
+
+// starts the status text of LastStatus, also from a callback in the middle of a wait
+void ShowStatus();
+int SolveSeconds = 5;		// Solve gives up after this long
 
 int main()
 {
@@ -79,6 +122,8 @@ int main()
 	glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
 	glfwSetKeyCallback(window, key_callback);
 	glfwSetMouseButtonCallback(window, mouse_button_callback);
+	glfwSetCursorPosCallback(window, cursor_position_callback);
+	glfwSetWindowRefreshCallback(window, window_refresh_callback);
 
 	// glad: load all OpenGL function pointers
 	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
@@ -95,17 +140,28 @@ int main()
 
 	// initialize buffers and shaders
 	Init();
+	Grid = new GridRenderer();
 
 	// configure sudoku solver
 	Sudoku = new SudokuSolver();
+	Solving = new AsyncSudokuSolver<3, 3>();
+
+	// configure puzzle generator
+	Generator = new SudokuGenerator();
+	Generator->SetSymmetry(Symmetry::Rotational);
 
 	// configure text renderer
 	RenderText = new TextRenderer(SCR_WIDTH, SCR_HEIGHT);
 	RenderText->Load("fonts/Antonio-Bold.ttf", 60);
 
+	// configure the table values, drawn with the glyphs of the text renderer
+	Digits = new CellRenderer(SCR_WIDTH, SCR_HEIGHT, RenderText);
+
 	// configure buttons
-	SolveButton = new Button(glm::vec2(SCR_WIDTH / 2.0f - 100.0f, 25.0f), glm::vec2(200.0f, 65.0f), glm::vec3(0.5f, 0.5f, 0.5f), "Solve");
-	ClearButton = new Button(glm::vec2(SCR_WIDTH / 2.0f - 100.0f, SCR_HEIGHT - 110.0f), glm::vec2(200.0f, 65.0f), glm::vec3(0.5f, 0.5f, 0.5f), "Clear");
+	SolveButton = new Button(glm::vec2(SCR_WIDTH / 2.0f - 210.0f, 25.0f), glm::vec2(200.0f, 65.0f), glm::vec3(0.5f, 0.5f, 0.5f), "Solve");
+	StepsButton = new Button(glm::vec2(SCR_WIDTH / 2.0f + 10.0f, 25.0f), glm::vec2(200.0f, 65.0f), glm::vec3(0.5f, 0.5f, 0.5f), "Steps");
+	ClearButton = new Button(glm::vec2(SCR_WIDTH / 2.0f - 210.0f, SCR_HEIGHT - 110.0f), glm::vec2(200.0f, 65.0f), glm::vec3(0.5f, 0.5f, 0.5f), "Clear");
+	NewButton = new Button(glm::vec2(SCR_WIDTH / 2.0f + 10.0f, SCR_HEIGHT - 110.0f), glm::vec2(200.0f, 65.0f), glm::vec3(0.5f, 0.5f, 0.5f), "New");
 
 
 	// render loop
@@ -120,26 +176,53 @@ int main()
 		// input
 		processInput(window);
 
+		// the status text disappears once its time is up, counted from when it was set
+		// so a text set by a callback is not aged by the wait it interrupted
+		float timer = (float)std::min(currentFrame - TextStart, (double)TextTimer);
+		if (Timer < TextTimer && timer == TextTimer)
+			Redraw = true;
+		Timer = timer;
+
+		// solver progress
+		if (FinishSolve())
+			Redraw = true;
+		if (AnimateSolve())
+			Redraw = true;
+
 
 		// rendering commands here
-		glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		if (Redraw || !RenderOnDemand)
+		{
+			Redraw = false;
 
-		Timer = std::min(Timer + (float)deltaTime, TextTimer);
+			glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-		DrawTable();
-		DrawButtons();
+			DrawTable();
+			DrawButtons();
+			DrawStats();
 
+			// all the text of the frame goes out in one draw call, on top of the rest
+			RenderText->Flush();
 
-		// check and call events and swap the buffers
-		glfwSwapBuffers(window);
-		glfwPollEvents();
+			glfwSwapBuffers(window);
+		}
+
+
+		// check and call events
+		WaitEvents();
 	}
 
+	delete Generator;
+	delete Solving;
 	delete Sudoku;
 	delete RenderText;
+	delete Grid;
+	delete Digits;
 	delete SolveButton;
+	delete StepsButton;
 	delete ClearButton;
+	delete NewButton;
 
 	// glfw: terminate, clearing all previously allocated GLFW resources
 	glfwTerminate();
@@ -153,17 +236,39 @@ int main()
 void framebuffer_size_callback(GLFWwindow* window, int width, int height)
 {
 	glViewport(0, 0, width, height);
+	Redraw = true;
+}
+
+void window_refresh_callback(GLFWwindow* window)
+{
+	Redraw = true;
+}
+
+void cursor_position_callback(GLFWwindow* window, double xpos, double ypos)
+{
+	// hover highlights follow the mouse
+	Redraw = true;
 }
 
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mode)
 {
+	Redraw = true;
+
 	if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
 		glfwSetWindowShouldClose(window, true);
 
-	if (InTable())
+	if (key == GLFW_KEY_UP && action == GLFW_PRESS)
+		StepsPerFrame = std::min(StepsPerFrame * 2, 1 << 16);
+
+	if (key == GLFW_KEY_DOWN && action == GLFW_PRESS)
+		StepsPerFrame = std::max(StepsPerFrame / 2, 1);
+
+	// the board is locked while it is being solved
+	if (InTable() && !BoardLocked())
 	{
 		int row = ((int)MouseY - TableUpY) / SquareSize + 1;
 		int column = ((int)MouseX - TableUpX) / SquareSize + 1;
+		bool valid = Sudoku->IsValid();
 
 		for (int i = 1; i < 10; i++)
 			if (key == GLFW_KEY_0 + i && action == GLFW_PRESS)
@@ -175,20 +280,33 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
 
 		if (key == GLFW_KEY_BACKSPACE && action == GLFW_PRESS)
 			Sudoku->SetTableValue(column, row, 0);
+
+		// SetTableValue checks every edit, so the one that repeats a value is reported before Solve
+		if (valid && !Sudoku->IsValid())
+		{
+			LastStatus = SolveStatus::Invalid;
+			ShowStatus();
+		}
 	}
 }
 
 void mouse_button_callback(GLFWwindow* window, int button, int action, int mods)
 {
+	Redraw = true;
+
 	if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS)
 	{
 		SolveButton->SetLeftMouse(true);
+		StepsButton->SetLeftMouse(true);
 		ClearButton->SetLeftMouse(true);
+		NewButton->SetLeftMouse(true);
 	}
 	else
 	{
 		SolveButton->SetLeftMouse(false);
+		StepsButton->SetLeftMouse(false);
 		ClearButton->SetLeftMouse(false);
+		NewButton->SetLeftMouse(false);
 	}
 }
 
@@ -196,7 +314,7 @@ void mouse_button_callback(GLFWwindow* window, int button, int action, int mods)
 //														Utility functions
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-GLuint SquareVAO, LineVAO;
+GLuint SquareVAO;
 void Init()
 {
 	// SQUARE
@@ -222,28 +340,9 @@ void Init()
 	glEnableVertexAttribArray(0);
 	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
 
-	// LINE
-	float LineVertices[] = {
-		0.0f, 0.0f,
-		1.0f, 0.0f,
-	};
-
-	GLuint LineVBO;
-	glGenVertexArrays(1, &LineVAO);
-	glGenBuffers(1, &LineVBO);
-
-	glBindVertexArray(LineVAO);
-
-	glBindBuffer(GL_ARRAY_BUFFER, LineVBO);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(LineVertices), LineVertices, GL_STATIC_DRAW);
-
-	glEnableVertexAttribArray(0);
-	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
-
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 	glBindVertexArray(0);
 
-	glDeleteBuffers(1, &LineVBO);
 	glDeleteBuffers(1, &SquareVBO);
 
 	// load shaders
@@ -260,7 +359,22 @@ void processInput(GLFWwindow* window)
 {
 	glfwGetCursorPos(window, &MouseX, &MouseY);
 	SolveButton->ProcessInput(MouseX, MouseY);
+	StepsButton->ProcessInput(MouseX, MouseY);
 	ClearButton->ProcessInput(MouseX, MouseY);
+	NewButton->ProcessInput(MouseX, MouseY);
+}
+
+void WaitEvents()
+{
+	// the animation needs every frame, a running solve and the status text only need to wake up in time
+	if (!RenderOnDemand || Animating)
+		glfwPollEvents();
+	else if (Solving->IsRunning())
+		glfwWaitEventsTimeout(SolvePollInterval);
+	else if (Timer < TextTimer)
+		glfwWaitEventsTimeout(TextTimer - Timer);
+	else
+		glfwWaitEvents();
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -274,58 +388,19 @@ bool InTable()
 
 void DrawTable()
 {
-	// draw rows and columns
-	glm::mat4 model = glm::mat4(1.0f);
-
-	ResourceManager::GetShader("line").Use();
-	ResourceManager::GetShader("line").SetVector3f("color", glm::vec3(0.9f, 0.9f, 0.9f));
-
-	glBindVertexArray(LineVAO);
-	
-	// draw rows
-	for (int y = (int)TableUpY, index = 0; y <= TableUpY + 9 * SquareSize; y += SquareSize, index++)
-	{
-		if (index % 3 == 0)
-			glLineWidth(4.0f);
-
-		model = glm::mat4(1.0f);
-		model = glm::translate(model, glm::vec3(TableUpX, y, 0.0f));
-		model = glm::scale(model, glm::vec3(9.0f * SquareSize, 0.0f, 0.0f));
-		ResourceManager::GetShader("line").SetMatrix4f("model", model);
-
-		glDrawArrays(GL_LINES, 0, 2);
-
-		if (index % 3 == 0)
-			glLineWidth(1.0f);
-	}
-
-	// draw columns
-	for (int x = (int)TableUpX, index = 0; x <= TableUpX + 9 * SquareSize; x += SquareSize, index++)
-	{
-		if (index % 3 == 0)
-			glLineWidth(4.0f);
+	// draw rows and columns, the buffer is only rebuilt if the table moved or resized
+	Grid->SetLayout(glm::vec2((float)TableUpX, (float)TableUpY), (float)SquareSize, 3, 3);
+	Grid->Render(glm::vec3(0.9f, 0.9f, 0.9f));
 
-		model = glm::mat4(1.0f);
-		model = glm::translate(model, glm::vec3(x, TableUpY, 0.0f));
-		model = glm::rotate(model, glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
-		model = glm::scale(model, glm::vec3(9.0f * SquareSize, 0.0f, 0.0f));
-		ResourceManager::GetShader("line").SetMatrix4f("model", model);
-
-		glDrawArrays(GL_LINES, 0, 2);
-
-		if (index % 3 == 0)
-			glLineWidth(1.0f);
-	}
-
-	// draw selected box
-	if (InTable())
+	// draw selected box, none while the board is being solved
+	if (InTable() && !BoardLocked())
 	{
 		int row = ((int)MouseY - TableUpY) / SquareSize;
 		int column = ((int)MouseX - TableUpX) / SquareSize;
 
 		glBindVertexArray(SquareVAO);
 
-		model = glm::mat4(1.0f);
+		glm::mat4 model = glm::mat4(1.0f);
 		model = glm::translate(model, glm::vec3(1.0f * TableUpX + column * SquareSize, 1.0f * TableUpY + row * SquareSize, 0.0f));
 		model = glm::scale(model, glm::vec3((float)SquareSize, (float)SquareSize, 0.0f));
 		ResourceManager::GetShader("line").SetMatrix4f("model", model);
@@ -334,42 +409,168 @@ void DrawTable()
 		glDrawArrays(GL_TRIANGLES, 0, 6);
 	}
 
-	// draw numbers
+	// draw numbers, only the cells that changed since the last frame are uploaded
+	Digits->SetLayout(glm::vec2((float)TableUpX, (float)TableUpY), (float)SquareSize, 9, 1.0f);
+
 	for (int x = 1; x < 10; x++)
 	{
 		for (int y = 1; y < 10; y++)
 		{
-			int value = Sudoku->GetTableValue(x, y);
-			if (value != 0)
-				RenderText->RenderText(std::to_string(value), 1.0f * TableUpX + (x - 1) * SquareSize + 20.0f, 1.0f * TableUpY + (y - 1) * SquareSize + 10.0f, 1.0f);
+			// values repeated in a row / column / square are drawn in red
+			CellState state = (Sudoku->IsConflicting(x, y) ? CellState::Conflicting : CellState::Normal);
+			Digits->SetCell((y - 1) * 9 + x - 1, Sudoku->GetTableValue(x, y), state);
 		}
 	}
+
+	Digits->Render();
 }
 
 void DrawButtons()
 {
 	SolveButton->Render(RenderText, glm::vec2(35.0f, 5.0f));
+	StepsButton->Render(RenderText, glm::vec2(35.0f, 5.0f));
 	ClearButton->Render(RenderText, glm::vec2(35.0f, 5.0f));
+	NewButton->Render(RenderText, glm::vec2(35.0f, 5.0f));
 
-	if (SolveButton->IsClicked())
+	// the solve runs in the background, a second click cancels it
+	if (SolveButton->IsClicked() && !Animating)
 	{
-		Timer = 0.0f;
+		// the click is handled after the buttons were drawn, show its result in the next frame
+		Redraw = true;
 
-		if (Sudoku->Solve())
-			SudokuError = false;
+		if (Solving->IsRunning())
+			Solving->Cancel();
 		else
-			SudokuError = true;
+			StartSolve();
 	}
 
-	if (Timer < TextTimer)
+	// the same button starts and stops the step by step solve
+	if (StepsButton->IsClicked() && !Solving->IsRunning())
 	{
-		if (SudokuError)
-			RenderText->RenderText("Invalid Sudoku", SCR_WIDTH / 2.0f - 80.0f, 95.0f, 0.5f, glm::vec3(1.0f, 0.0f, 0.0f));
-		else
+		Redraw = true;
+
+		if (Animating)
+		{
+			Sudoku->StopSteps();
+			Animating = false;
+			StepsButton->SetText("Steps");
+		}
+		else if (Sudoku->StartSteps())
+		{
+			Animating = true;
+			StepsButton->SetText("Stop");
+		}
+	}
+
+	if (BoardLocked())
+		RenderText->RenderText("Solving...", SCR_WIDTH / 2.0f - 60.0f, 95.0f, 0.5f);
+	else if (Timer < TextTimer)
+	{
+		if (LastStatus == SolveStatus::Solved)
 			RenderText->RenderText("Valid Sudoku", SCR_WIDTH / 2.0f - 80.0f, 95.0f, 0.5f, glm::vec3(0.0f, 1.0f, 0.0f));
+		else if (LastStatus == SolveStatus::BudgetExceeded)
+			RenderText->RenderText("Solve stopped", SCR_WIDTH / 2.0f - 80.0f, 95.0f, 0.5f, glm::vec3(1.0f, 0.5f, 0.0f));
+		else
+			RenderText->RenderText("Invalid Sudoku", SCR_WIDTH / 2.0f - 80.0f, 95.0f, 0.5f, glm::vec3(1.0f, 0.0f, 0.0f));
+	}
+
+	if (ClearButton->IsClicked() && !BoardLocked())
+	{
+		Sudoku->Clear();
+		Redraw = true;
 	}
 
-	if (ClearButton->IsClicked())
-			Sudoku->Clear();
+	if (NewButton->IsClicked() && !BoardLocked())
+	{
+		NewPuzzle();
+		Redraw = true;
+	}
+}
+
+void StartSolve()
+{
+	std::uint8_t puzzle[SudokuSolver::Cells];
+	for (int i = 0; i < SudokuSolver::Cells; i++)
+		puzzle[i] = (std::uint8_t)Sudoku->GetTableValue(i / 9 + 1, i % 9 + 1);
+
+	// stop a puzzle that takes too long even if nobody cancels it
+	SolveLimits limits;
+	limits.Deadline = std::chrono::steady_clock::now() + std::chrono::seconds(SolveSeconds);
+
+	Solving->Start(puzzle, limits);
+	SolveButton->SetText("Cancel");
 }
 
+bool FinishSolve()
+{
+	std::uint8_t solution[SudokuSolver::Cells];
+	if (!Solving->Poll(solution, LastStatus))
+		return false;
+
+	LastStats = Solving->GetStats();
+
+	// the whole board is written in one go between two frames
+	if (LastStatus == SolveStatus::Solved)
+		for (int i = 0; i < SudokuSolver::Cells; i++)
+			Sudoku->SetTableValue(i / 9 + 1, i % 9 + 1, solution[i]);
+
+	ShowStatus();
+	SolveButton->SetText("Solve");
+	return true;
+}
+
+bool AnimateSolve()
+{
+	if (!Animating)
+		return false;
+
+	for (int i = 0; i < StepsPerFrame; i++)
+	{
+		StepResult result = Sudoku->Step();
+		if (result == StepResult::Placed || result == StepResult::Backtracked)
+			continue;
+
+		LastStatus = (result == StepResult::Solved ? SolveStatus::Solved : SolveStatus::Unsolvable);
+		LastStats = Sudoku->GetStats();
+		ShowStatus();
+
+		Animating = false;
+		StepsButton->SetText("Steps");
+		break;
+	}
+
+	return true;
+}
+
+void ShowStatus()
+{
+	TextStart = glfwGetTime();
+	Timer = 0.0f;
+}
+
+bool BoardLocked()
+{
+	return Solving->IsRunning() || Animating;
+}
+
+void DrawStats()
+{
+#ifdef SUDOKU_STATS
+	std::string text = "nodes " + std::to_string(LastStats.Nodes) + "   backtracks " + std::to_string(LastStats.Backtracks)
+		+ "   depth " + std::to_string(LastStats.MaxDepth) + "   singles " + std::to_string(LastStats.NakedSingles + LastStats.HiddenSingles)
+		+ "   search " + std::to_string((int)(1000000.0 * LastStats.SearchTime)) + " us";
+
+	RenderText->RenderText(text, 1.0f * TableUpX, TableUpY + 9.0f * SquareSize + 8.0f, 0.3f, glm::vec3(0.7f, 0.7f, 0.7f));
+#endif
+}
+
+void NewPuzzle()
+{
+	// a 9x9 puzzle takes well under a millisecond, no need to leave the render thread
+	std::uint8_t puzzle[SudokuSolver::Cells];
+	Generator->Generate(puzzle);
+
+	Sudoku->Clear();
+	for (int i = 0; i < SudokuSolver::Cells; i++)
+		Sudoku->SetTableValue(i / 9 + 1, i % 9 + 1, puzzle[i]);
+}